@@ -3,7 +3,7 @@
 from .block import DataBlock, SectionBlock
 from .config import ConfigBlock, ConfigError
 from .module import BaseModule, mimport
-from .pipeline import BasePipeline, StreamPipeline, MPIPipeline, BatchPipeline
+from .pipeline import BasePipeline, StreamPipeline, DAGPipeline, MPIPipeline, BatchPipeline
 from .utils import setup_logging
 from . import section_names
 #from . import syntax
@@ -7,6 +7,7 @@ from ._version import __version__
 from .utils import setup_logging
 from .main import main as pypescript_main
 from .mpi import CurrentMPIComm
+from .block import compact_checkpoint
 
 
 ascii_art = """\
@@ -24,15 +25,21 @@ ascii_art = """\
 def main(args=None):
     if CurrentMPIComm.get().rank == 0: print(ascii_art)
     parser = argparse.ArgumentParser(description=main.__doc__,formatter_class=argparse.ArgumentDefaultsHelpFormatter)
-    parser.add_argument('config_block_fn', type=str, help='Name of configuration file')
+    parser.add_argument('config_block_fn', type=str, nargs='?', default=None, help='Name of configuration file')
     parser.add_argument('--pipe-graph-fn', type=str, default=None,
                         help='If provided, save graph of the pipeline to this file name')
     parser.add_argument('--data-block-fn', type=str, default=None, help='If provided, path to the data_block to start from')
     parser.add_argument('--save-data-block-fn', type=str, default=None, help='If provided, path to the data_block to save')
+    parser.add_argument('--compact-checkpoint', type=str, default=None,
+                        help='If provided, rewrite this checkpoint file (see DataBlock.checkpoint) as a single record, and exit')
     parser.add_argument('--log-level', type=str, default='info', choices=['warning','info','debug'],
                         help='Logging level')
     opt = parser.parse_args(args=args)
     setup_logging(level=opt.log_level)
+    if opt.compact_checkpoint is not None:
+        return compact_checkpoint(opt.compact_checkpoint)
+    if opt.config_block_fn is None:
+        parser.error('the following arguments are required: config_block_fn')
     return pypescript_main(config_block=opt.config_block_fn,pipe_graph_fn=opt.pipe_graph_fn,data_block=opt.data_block_fn,save_data_block=opt.save_data_block_fn)
 
 
@@ -1,14 +1,249 @@
 """Definition of :class:`DataBlock` and related classes."""
 
+import os
 import re
+import json
+import pickle
+import weakref
 import logging
+import importlib
+
+import numpy as np
 
 from . import utils
 from .utils import BaseClass
 from . import syntax
 from . import section_names
 from .lib import block
-from .mpi import CurrentMPIComm
+from .lib.block import array_conversions, TRACE_GET, TRACE_HAS, TRACE_SET, TRACE_DEL
+from .mpi import CurrentMPIComm, CurrentMPIState, MPI
+
+
+block_file_magic = b'PYPEBLK1'
+block_file_alignment = 64
+# MPI shared-memory windows holding arrays of DataBlock instances loaded with shared=True, by creation index
+shared_windows = {}
+# indices of windows whose arrays have all been released on this rank, to be freed (collectively) by free_shared_windows
+_released_windows = set()
+
+
+def _align(offset, alignment=block_file_alignment):
+    return -(-offset // alignment) * alignment
+
+
+class _ScatteredEntry(object):
+
+    """Placeholder for an entry of :class:`DataBlock` scattered over ranks, saved in per-rank shard files."""
+
+    def __init__(self, cls, index, nshards):
+        self.cls = cls
+        self.index = index
+        self.nshards = nshards
+
+
+class _LazyDict(object):
+
+    """Dictionary whose items are produced one at a time, when written by :func:`write_block_file`."""
+
+    def __init__(self, items):
+        self._items = items
+
+    def items(self):
+        return self._items
+
+
+def _class_path(cls):
+    return '{}:{}'.format(cls.__module__,cls.__qualname__)
+
+
+def _import_class(path):
+    module, qualname = path.split(':')
+    toret = importlib.import_module(module)
+    for name in qualname.split('.'): toret = getattr(toret,name)
+    return toret
+
+
+def _decode_value(desc, buffer, scattered=None):
+    """
+    Return value from description ``desc`` written by :func:`write_block_file`, with payload ``buffer``.
+    Scattered entries are returned by ``scattered(cls, index, nshards)``.
+    """
+    if 'value' in desc:
+        return desc['value']
+    if 'class' in desc:
+        return _import_class(desc['class'])
+    if 'array' in desc:
+        offset, dtype, shape = desc['array']
+        dtype = np.dtype(dtype)
+        return buffer[offset:offset + dtype.itemsize*int(np.prod(shape))].view(dtype).reshape(shape)
+    if 'dict' in desc:
+        return {key:_decode_value(item,buffer,scattered=scattered) for key,item in desc['dict'].items()}
+    if 'scattered' in desc:
+        if scattered is None:
+            raise ValueError('Cannot read scattered entries without their shard files')
+        path, index, nshards = desc['scattered']
+        return scattered(_import_class(path),index,nshards)
+    offset, nbytes = desc['pickle']
+    return pickle.loads(buffer[offset:offset + nbytes])
+
+
+def is_block_file(filename):
+    """Whether ``filename`` is in the native :class:`DataBlock` file format (see :meth:`DataBlock.save`)."""
+    with open(filename,'rb') as file:
+        return file.read(len(block_file_magic)) == block_file_magic
+
+
+def block_shard_filename(filename, rank):
+    """Return path to the file holding scattered entries of rank ``rank``, for :class:`DataBlock` file ``filename``."""
+    return '{}.{:d}'.format(filename,rank)
+
+
+def _write_block(file, state, position=0):
+    """
+    Write state dictionary ``state`` in ``file`` at ``position`` (see :func:`write_block_file`); return position of the end of the record.
+    Offsets are relative to ``position``, such that records can be appended one after the other.
+    """
+    start = position + _align(len(block_file_magic) + 16)
+
+    def encode(value, offset):
+        # return description of value that can be dumped in JSON, and offset in the payload after value
+        if value is None or type(value) in (bool,int,float,str):
+            return {'value':value}, offset
+        if isinstance(value,type):
+            return {'class':_class_path(value)}, offset
+        if isinstance(value,_ScatteredEntry):
+            return {'scattered':[_class_path(value.cls),value.index,value.nshards]}, offset
+        if type(value) in (np.ndarray,np.memmap) and value.dtype.fields is None and not value.dtype.hasobject:
+            if not value.flags.c_contiguous: value = value.copy(order='C')
+            offset = _align(offset)
+            file.seek(start + offset)
+            file.write(value.reshape(-1).view('u1'))
+            return {'array':[offset,value.dtype.str,list(value.shape)]}, offset + value.nbytes
+        if isinstance(value,_LazyDict) or (type(value) is dict and all(isinstance(key,str) for key in value)):
+            toret = {}
+            for key,item in value.items():
+                toret[key], offset = encode(item,offset)
+            return {'dict':toret}, offset
+        file.seek(start + offset)
+        pickle.dump(value,file,protocol=pickle.HIGHEST_PROTOCOL)
+        nbytes = file.tell() - start - offset
+        return {'pickle':[offset,nbytes]}, offset + nbytes
+
+    header, size = encode(state,0)
+    header = json.dumps(header).encode('utf-8')
+    file.seek(start + size)
+    file.write(header)
+    file.seek(position + len(block_file_magic))
+    file.write(np.array([start + size - position,len(header)],dtype=np.uint64).tobytes())
+    # magic string last, such that an interrupted record is not recognized
+    file.seek(position)
+    file.write(block_file_magic)
+    return start + size + len(header)
+
+
+def write_block_file(filename, state):
+    """
+    Write state dictionary ``state`` to ``filename`` in the native :class:`DataBlock` file format:
+    magic string, offset and size of the header, aligned raw array and pickle payloads, then JSON header describing values.
+    Payloads are written as soon as they are encoded, such that at most one value (e.g. a non-contiguous array, or pickled object)
+    is copied in memory at a time; dictionaries may be :class:`_LazyDict`, in which case values are computed one at a time as well.
+    """
+    with open(filename,'wb') as file:
+        _write_block(file,state)
+
+
+def _read_block_header(file, filename=None):
+    """
+    Return header, offset and size of the payload, and end of the :class:`DataBlock` record
+    starting at the current position of ``file``.
+    """
+    position = file.tell()
+    if file.read(len(block_file_magic)) != block_file_magic:
+        raise ValueError('{} is not a DataBlock file'.format(filename))
+    offset, size = np.frombuffer(file.read(16),dtype=np.uint64).tolist()
+    start = position + _align(len(block_file_magic) + 16)
+    file.seek(position + offset)
+    header = json.loads(file.read(size).decode('utf-8'))
+    return header, start, position + offset - start, position + offset + size
+
+
+def _free_released_windows(nodecomm):
+    """Free (collectively on ``nodecomm``) shared-memory windows whose arrays have been released on all ranks of ``nodecomm``."""
+    released = set.intersection(*map(set,nodecomm.allgather(sorted(_released_windows))))
+    for index in sorted(released):
+        shared_windows.pop(index).Free()
+        _released_windows.discard(index)
+
+
+@CurrentMPIComm.enable
+def free_shared_windows(mpicomm=None):
+    """
+    Free shared-memory windows (see :meth:`DataBlock.load` with ``shared=True``) whose arrays have been released on all ranks of each node.
+    Collective on ``mpicomm``; this is also done at each shared load.
+    """
+    nodecomm = mpicomm.Split_type(MPI.COMM_TYPE_SHARED,key=mpicomm.rank)
+    _free_released_windows(nodecomm)
+    nodecomm.Free()
+
+
+def read_block_file(filename, mmap_mode='c', nodecomm=None, scattered=None):
+    """
+    Return state dictionary from ``filename`` written by :func:`write_block_file`.
+    If ``mmap_mode`` is not ``None``, arrays are views of a ``np.memmap`` of the file opened with this mode,
+    i.e. they are read from disk only when accessed.
+    If ``nodecomm`` (communicator of ranks sharing memory) is provided, the payload is read by its rank 0 only,
+    into an MPI shared-memory window, and arrays are read-only views of this window on all ranks of ``nodecomm``.
+    Windows are kept in :data:`shared_windows` until arrays viewing them are released on all ranks, and freed at the next shared load,
+    or call to :func:`free_shared_windows` (as freeing a window is collective).
+    Scattered entries are returned by ``scattered(cls, index, nshards)``.
+    """
+    if nodecomm is not None:
+        header, start, size = None, 0, 0
+        if nodecomm.rank == 0:
+            with open(filename,'rb') as file:
+                header, start, size = _read_block_header(file,filename)[:3]
+        header, start, size = nodecomm.bcast((header,start,size),root=0)
+        _free_released_windows(nodecomm)
+        win = MPI.Win.Allocate_shared(size if nodecomm.rank == 0 else 0,1,comm=nodecomm)
+        index = max(shared_windows,default=-1) + 1
+        shared_windows[index] = win
+        # all arrays are views of buffer: window can be freed once it is garbage-collected
+        buffer = np.ndarray(buffer=win.Shared_query(0)[0],dtype='u1',shape=(size,))
+        weakref.finalize(buffer,_released_windows.add,index)
+        if nodecomm.rank == 0 and size:
+            with open(filename,'rb') as file:
+                file.seek(start)
+                file.readinto(buffer)
+        nodecomm.Barrier()
+        buffer.flags.writeable = False
+        return _decode_value(header,buffer,scattered=scattered)
+
+    with open(filename,'rb') as file:
+        header, start, size = _read_block_header(file,filename)[:3]
+        if not size:
+            buffer = np.empty(0,dtype='u1')
+        elif mmap_mode is None:
+            buffer = np.empty(size + block_file_alignment,dtype='u1')
+            shift = -buffer.ctypes.data % block_file_alignment
+            buffer = buffer[shift:shift + size]
+            file.seek(start)
+            file.readinto(buffer)
+        else:
+            buffer = np.memmap(filename,dtype='u1',mode=mmap_mode,offset=start,shape=(size,))
+    return _decode_value(header,buffer,scattered=scattered)
+
+
+@CurrentMPIComm.enable
+def compact_checkpoint(filename, mpicomm=None):
+    """Rewrite log-structured checkpoint file ``filename`` (see :meth:`DataBlock.checkpoint`) as a single full record."""
+    if mpicomm.rank == 0:
+        block = DataBlock.restore(filename,mmap_mode='r',mpicomm=MPI.COMM_SELF)
+        tmp_filename = '{}.tmp'.format(filename)
+        with open(tmp_filename,'wb') as file:
+            record = {'reset':True,'sections':block.__getstate__()['data'],'deleted_sections':{},'data':{},'deleted':{},'mapping':block.mapping.__getstate__()}
+            _write_block(file,record)
+        os.replace(tmp_filename,filename)
+    mpicomm.Barrier()
 
 
 class BlockMapping(block.BlockMapping,BaseClass):
@@ -19,8 +254,9 @@ class BlockMapping(block.BlockMapping,BaseClass):
 
     Attributes
     ----------
-    data : dict
-        Single level dictionary containing (section, name) mapping.
+    data : mappingproxy
+        Read-only view of the single level dictionary containing (section, name) mapping;
+        modify the mapping with its item assignment, deletion, :meth:`update` and :meth:`clear` methods.
 
     Note
     ----
@@ -62,7 +298,7 @@ class BlockMapping(block.BlockMapping,BaseClass):
 
     def __getstate__(self):
         """Return this class state dictionary."""
-        return {'data':self.data}
+        return {'data':dict(self.data)}
 
     def __setstate__(self, state):
         """Set the class state dictionary."""
@@ -98,7 +334,28 @@ class DataBlock(block.DataBlock,BaseClass):
 
     It is essentially a dictionary, with items to be accessed through the key (section, name).
     Most useful methods are those to get (get, get_type, get_[type]...) and set objects.
-    The class mostly inherits from the DataBlock type coded using the Python C API.
+    The class mostly inherits from the DataBlock type coded using the Python C API, which provides in particular:
+
+    - ``copy(nocopy=None)``: shallow copy, i.e. only the dictionary mapping to the stored items is copied,
+      except items with an attribute ``_copy_if_datablock_copy`` set to ``True``, which are copied as well.
+      Sections in ``nocopy`` (defaults to :attr:`syntax.common_sections`) are **not** copied, such that any change affecting
+      these sections of ``self`` will affect the returned copy as well. :attr:`mapping` is not copied either.
+      Section dictionaries are shared between ``self`` and the copy until either writes to them (copy-on-write).
+    - ``update(other, nocopy=None)``: update ``self`` with the sections of ``other``, with ``nocopy`` as above
+      (only common sections already in ``self``). :attr:`mapping` is **not** updated.
+    - ``setdefault(section, name, value)``: set ``value`` if (section, name) is not in ``self``.
+    - iteration over (section, name) keys, without building the list of keys.
+    - ``keys(section=None)``, ``items(section=None)``, ``values(section=None)``: dict-like views over (section, name) keys,
+      ((section, name), value) items and values, optionally restricted to ``section``, ignoring :attr:`mapping`.
+    - ``set_trace(trace)``: record (section, name) accesses (after :attr:`mapping`) into dictionary ``trace``, as ``trace[section][name]``
+      flags ``TRACE_GET | TRACE_HAS | TRACE_SET | TRACE_DEL`` (``name`` is ``None`` for whole-section accesses); stop if ``None``.
+      This includes accesses by compiled modules; :attr:`trace` is not passed to copies.
+      Handing out a section dictionary (``self[section]``) counts as ``TRACE_GET | TRACE_SET``, iterating over a view as ``TRACE_HAS`` (keys)
+      or ``TRACE_GET`` of the sections concerned, and getting :attr:`data`, which allows any access, as ``trace[None][None] = TRACE_GET | TRACE_SET``.
+    - ``set_items(items)``: set (key, value) pairs of sequence ``items``; ``duplicate(pairs, source=None)``: for (keyg, keyl) pairs of sequence ``pairs``,
+      set ``self[keyg] = self[keyl]`` if ``keyl`` in ``self`` (and, if ``source`` is provided, ``keyg != keyl``), else ``self[keyg] = source[keyl]``
+      if ``keyl`` in ``source``. Used by modules to apply ``$datablock_set`` and ``$datablock_duplicate``.
+
     Only a few convenience methods are written in Python below.
 
     >>> data_block = DataBlock({'section1':{'name1':1}})
@@ -115,6 +372,10 @@ class DataBlock(block.DataBlock,BaseClass):
     mapping : BlockMapping
         See documentation of :class:`BlockMapping`.
 
+    dirty : dict, None
+        Dictionary of sets of names (``None`` for the whole section) set or deleted in each section since last call to ``set_dirty({})``,
+        or ``None`` if not recorded (the default, see ``set_dirty``). Used by :meth:`checkpoint`.
+
     """
     logger = logging.getLogger('DataBlock')
 
@@ -136,19 +397,15 @@ class DataBlock(block.DataBlock,BaseClass):
             List of sections to be added to ``self``.
             If ``None``, defaults to :attr:`syntax.common_sections`.
         """
-        if isinstance(data,str) and data.endswith(syntax.block_save_extension):
+        if isinstance(data,str) and data.endswith((syntax.block_save_extension,syntax.block_file_extension)):
             new = self.load(data)
-            super(DataBlock,self).__init__(data=new.data,mapping=new.mapping)
+            super(DataBlock,self).__init__(data=new.data,mapping=new.mapping,add_sections=[])
             return
 
         if not isinstance(mapping,BlockMapping):
             mapping = BlockMapping(mapping)
 
-        super(DataBlock,self).__init__(data=data,mapping=mapping)
-        if add_sections is None:
-            add_sections = syntax.common_sections
-        for section in add_sections:
-            if section not in self: self[section] = {}
+        super(DataBlock,self).__init__(data=data,mapping=mapping,add_sections=add_sections)
         self.setdefault(section_names.mpi,'comm',CurrentMPIComm.get())
 
     def get_type(self, section, name, types, *args, **kwargs):
@@ -211,68 +468,29 @@ class DataBlock(block.DataBlock,BaseClass):
         """
         return super(DataBlock,self).set_mapping(mapping if isinstance(mapping,BlockMapping) else BlockMapping(mapping))
 
-    def copy(self, nocopy=None):
-        """
-        Return a shallow copy of ``self``, i.e. only the dictionary mapping to the stored items is copied.
-        The items themselves are not copied, except if they have an attribute ``_copy_if_datablock_copy`` set to ``True``.
+    def __getstate__(self):
+        """Return this class state dictionary."""
+        data = {section:self._get_section_state(section) for section in self.sections()}
+        return {'data':data,'mapping':self.mapping.__getstate__()}
 
-        Parameters
-        ----------
-        nocopy : list, default=None
-            List of sections to **not** copy (such that any change affecting in these sections of ``self`` will affect the
-            returned copy as well).
-            If ``None``, defaults to :attr:`syntax.common_sections`.
+    def _get_section_state(self, section, names=None):
+        """Return state dictionary of ``section`` (restricted to ``names`` if not ``None``), without :attr:`mapping`."""
+        return dict(self._iter_section_state(section,names=names))
 
-        Note
-        ----
-        :attr:`mapping` instance is simply added to the returned :class:`DataBlock` instance, no copy is performed.
-        """
-        if nocopy is None:
-            nocopy = [section for section in syntax.common_sections if section in self]
-        new = self.__class__(mapping=self.mapping,add_sections=[])
-        for section in self.sections():
-            if section in nocopy:
-                new[section] = self[section]
-                continue
-            new_section = {}
-            for name,value in self[section].items():
-                if getattr(value,syntax.copy_if_datablock_copy,False):
-                    value = value.copy()
-                new_section[name] = value
-            new[section] = new_section
-        return new
-
-    def update(self, other, nocopy=None):
+    def _iter_section_state(self, section, names=None, scattered=None):
         """
-        Update ``self``, i.e. only the dictionary mapping to the stored items is updated with ``other``, not the items themselves.
-
-        Parameters
-        ----------
-        nocopy : list, default=None
-            List of sections to **not** update (such that any change affecting in these sections of ``other`` will affect ``self`` as well.
-            If ``None``, defaults to :attr:`syntax.common_sections`.
-
-        Note
-        ----
-        :attr:`mapping` instance is **not** updated.
+        Yield (name, state) of values in ``section`` (restricted to ``names`` if not ``None``), states being computed one at a time.
+        Values whose key is in dictionary ``scattered`` are replaced by the corresponding placeholder.
         """
-        if nocopy is None:
-            nocopy = [section for section in syntax.common_sections if section in self]
-        return super(DataBlock,self).update(other,nocopy=nocopy)
-
-    def __getstate__(self):
-        """Return this class state dictionary."""
-        data = {}
-        for section in self.sections():
-            data[section] = {}
-            for name, value in self[section].items():
-                if (section,name) == (section_names.mpi,'comm'):
-                    continue
-                if hasattr(value,'__getstate__'):
-                    data[section][name] = {'__class__':value.__class__,'__dict__':value.__getstate__()}
-                else:
-                    data[section][name] = value
-        return {'data':data,'mapping':self.mapping.__getstate__()}
+        for (section,name),value in self.items(section):
+            if (section,name) == (section_names.mpi,'comm') or (names is not None and name not in names):
+                continue
+            if scattered is not None and (section,name) in scattered:
+                yield name, scattered[section,name]
+            elif hasattr(value,'from_state'):
+                yield name, {'__class__':value.__class__,'__dict__':value.__getstate__()}
+            else:
+                yield name, value
 
     def __setstate__(self, state):
         """Set the class state dictionary."""
@@ -284,16 +502,140 @@ class DataBlock(block.DataBlock,BaseClass):
                     data[section][name] = value['__class__'].from_state(value['__dict__'])
                 else:
                     data[section][name] = value
-        super(DataBlock,self).__init__(data=data,mapping=BlockMapping.from_state(state['mapping']))
+        super(DataBlock,self).__init__(data=data,mapping=BlockMapping.from_state(state['mapping']),add_sections=[])
 
-    def __iter__(self, **kwargs):
-        """Iter. TODO: implement in C."""
-        return iter(self.keys(**kwargs))
-
-    def setdefault(self, section, name, value):
-        """Set default value. TODO: implement in C."""
-        if (section,name) not in self:
-            self.set(section,name,value)
+    @classmethod
+    @CurrentMPIComm.enable
+    def load(cls, filename, mpiroot=0, mmap_mode='c', shared=False, mpicomm=None):
+        """
+        Load from disk. Files in the native format (see :meth:`save`) are read by all ranks, arrays being memory-mapped
+        with ``mmap_mode`` (see :func:`read_block_file`); others are read on ``mpiroot`` and broadcast to all ranks.
+        If ``shared``, arrays of native files are read once per node, into MPI shared memory, and are read-only.
+        Scattered entries are read by each rank from its shard file (see :meth:`save`), which requires as many ranks as when saving.
+        """
+        if filename.endswith(syntax.block_save_extension) or not is_block_file(filename):
+            if shared: cls.log_warning('Cannot share memory when loading {} (not a DataBlock file).'.format(filename),rank=0)
+            return super(DataBlock,cls).load(filename,mpiroot=mpiroot,mpicomm=mpicomm)
+        cls.log_info('Loading {}.'.format(filename))
+        nodecomm = None
+        if shared:
+            nodecomm = mpicomm.Split_type(MPI.COMM_TYPE_SHARED,key=mpicomm.rank)
+            if nodecomm.size == 1:
+                nodecomm.Free()
+                nodecomm = None
+        shard = {}
+
+        def scattered(cls, index, nshards):
+            if nshards != mpicomm.size:
+                raise ValueError('{} has scattered entries saved with {:d} ranks, cannot be loaded with {:d} ranks'.format(filename,nshards,mpicomm.size))
+            if not shard:
+                shard.update(read_block_file(block_shard_filename(filename,mpicomm.rank),mmap_mode=mmap_mode))
+            return cls.from_state(shard[str(index)],mpistate=CurrentMPIState.SCATTERED,mpiroot=mpiroot,mpicomm=mpicomm)
+
+        state = read_block_file(filename,mmap_mode=mmap_mode,nodecomm=nodecomm,scattered=scattered)
+        if nodecomm is not None: nodecomm.Free()
+        return cls.from_state(state,mpiroot=mpiroot,mpicomm=mpicomm)
+
+    @utils.savefile
+    def save(self, filename):
+        """
+        Save to disk. If ``filename`` ends with :attr:`syntax.block_save_extension`, the state dictionary is pickled with ``np.save``.
+        Else, the native format is used (see :func:`write_block_file`), where arrays are stored raw and can be memory-mapped by :meth:`load`;
+        values are encoded and written one at a time, and entries scattered over ranks are written by each rank in its own shard file
+        (see :func:`block_shard_filename`), instead of being gathered; non-root ranks only encode their scattered entries.
+        """
+        if filename.endswith(syntax.block_save_extension):
+            if self.is_mpi_root():
+                np.save(filename,self.__getstate__())
+            return
+        scattered = [key for key,value in self.items() if getattr(value,'is_mpi_scattered',None) is not None and value.is_mpi_scattered()]
+        if scattered:
+            shard = _LazyDict((str(index),self[key].__getstate__()) for index,key in enumerate(scattered))
+            write_block_file(block_shard_filename(filename,self.mpicomm.rank),shard)
+        if self.is_mpi_root():
+            scattered = {key:_ScatteredEntry(self[key].__class__,index,self.mpicomm.size) for index,key in enumerate(scattered)}
+            data = _LazyDict((section,_LazyDict(self._iter_section_state(section,scattered=scattered))) for section in self.sections())
+            write_block_file(filename,{'data':data,'mapping':self.mapping.__getstate__()})
+
+    @utils.savefile
+    def checkpoint(self, filename):
+        """
+        Append a checkpoint of ``self`` to the log-structured file ``filename``, to be replayed by :meth:`restore`.
+        The first checkpoint (or the first one since a checkpoint to another file) holds all entries, the next ones only the entries set or deleted since
+        the previous checkpoint (as recorded in :attr:`dirty`). Modifications of values in place (e.g. of arrays) are not recorded:
+        set them again to have them checkpointed.
+        """
+        for key,value in self.items():
+            if getattr(value,'is_mpi_scattered',None) is not None and value.is_mpi_scattered():
+                raise ValueError('Cannot checkpoint scattered entry {}; use save()'.format(key))
+        dirty = self.dirty
+        full = dirty is None or getattr(self,'_checkpoint_filename',None) != filename or not os.path.isfile(filename)
+        self._checkpoint_filename = filename
+        self.set_dirty({})
+        if not self.is_mpi_root():
+            return
+        record = {'reset':full,'sections':{},'deleted_sections':{},'data':{},'deleted':{},'mapping':self.mapping.__getstate__()}
+        if full:
+            dirty = {section:{None} for section in self.sections()}
+        for section,names in dirty.items():
+            if section not in self:
+                record['deleted_sections'][section] = None
+            elif None in names:
+                record['sections'][section] = self._get_section_state(section)
+            else:
+                record['data'][section] = self._get_section_state(section,names=names)
+                record['deleted'][section] = {name:None for name in names if name not in record['data'][section]}
+        mode = 'wb' if full else 'r+b'
+        with open(filename,mode) as file:
+            file.seek(0,2)
+            _write_block(file,record,position=_align(file.tell()))
+
+    @classmethod
+    @CurrentMPIComm.enable
+    def restore(cls, filename, mmap_mode='c', mpiroot=0, mpicomm=None):
+        """
+        Return :class:`DataBlock` in the state of the last checkpoint written by :meth:`checkpoint` in ``filename``,
+        replaying records from the last full one. Arrays are memory-mapped following ``mmap_mode`` (see :func:`read_block_file`).
+        An incomplete last record (e.g. if the run was interrupted while writing it) is ignored.
+        """
+        cls.log_info('Restoring {}.'.format(filename),rank=0)
+        records = []
+        with open(filename,'rb') as file:
+            file.seek(0,2)
+            end, position = file.tell(), 0
+            while position < end:
+                file.seek(position)
+                try:
+                    header, start, size, stop = _read_block_header(file,filename)
+                    if stop > end: raise ValueError
+                except ValueError:
+                    cls.log_warning('Ignoring incomplete checkpoint at byte {:d} of {}.'.format(position,filename),rank=0)
+                    break
+                if _decode_value(header['dict']['reset'],None):
+                    records = []
+                records.append((header,start,size))
+                length, position = stop, _align(stop)
+        if not records:
+            raise ValueError('No checkpoint in {}'.format(filename))
+        if mmap_mode is None:
+            buffer = np.empty(length + block_file_alignment,dtype='u1')
+            shift = -buffer.ctypes.data % block_file_alignment
+            buffer = buffer[shift:shift + length]
+            with open(filename,'rb') as file:
+                file.readinto(buffer)
+        else:
+            buffer = np.memmap(filename,dtype='u1',mode=mmap_mode,shape=(length,))
+        data = {}
+        for header,start,size in records:
+            record = _decode_value(header,buffer[start:start + size])
+            for section in record['deleted_sections']:
+                data.pop(section,None)
+            data.update(record['sections'])
+            for section,names in record['deleted'].items():
+                for name in names: data.setdefault(section,{}).pop(name,None)
+            for section,items in record['data'].items():
+                data.setdefault(section,{}).update(items)
+        return cls.from_state({'data':data,'mapping':record['mapping']},mpiroot=mpiroot,mpicomm=mpicomm)
 
     def mpi_distribute(self, dests, mpicomm=None):
         for key,value in self.items():
@@ -346,7 +688,8 @@ class SectionBlock(object):
 
     def items(self):
         """Yield (name, value) tuples."""
-        yield from self.block[self.section].items()
+        for (section,name),value in self.block.items(section=self.section):
+            yield name,value
 
     def has(self, name):
         """Has this ``name``?"""
@@ -14,6 +14,15 @@
     }\
   }\
 
+// Bumped each time any BlockMapping is modified; BlockMapping instances may share their data dictionary,
+// hence a single counter, used by DataBlock to invalidate its cache of resolved (section, name)
+static unsigned long long mapping_version = 0;
+
+unsigned long long PyBlockMapping_Version(void)
+{
+  return mapping_version;
+}
+
 int PyBlockMapping_SetItem(PyBlockMapping *self, PyObject *key, PyObject *value)
 {
   int toret = 0;
@@ -29,6 +38,7 @@ int PyBlockMapping_SetItem(PyBlockMapping *self, PyObject *key, PyObject *value)
     goto except;
   }
   toret = PyDict_SetItem((PyObject *) self->data, key, value);
+  mapping_version++;
   goto finally;
 except:
   toret = -1;
@@ -42,6 +52,7 @@ int PyBlockMapping_DelItem(PyBlockMapping *self, PyObject *key)
 {
   MAKE_TUPLE(key)
   int toret = PyDict_DelItem((PyObject *) self->data, key);
+  mapping_version++;
   goto finally;
 except:
   toret = -1;
@@ -110,6 +121,11 @@ int PyBlockMapping_ParseSectionName(PyBlockMapping *self, PyObject * section, Py
 {
   int toret = 1;
   PyObject *key = NULL, *value = NULL;
+  if (PyBlockMapping_IsEmpty(self)) {
+    *true_section = section;
+    *true_name = name;
+    goto finally;
+  }
   key = Py_BuildValue("(OO)", section, name);
   if (key == NULL) goto except;
   if (PyBlockMapping_Contains(self, key) == 1) {
@@ -151,6 +167,7 @@ PyObject * PyBlockMapping_Items(PyBlockMapping *self) {
 void PyBlockMapping_Clear(PyBlockMapping *self)
 {
   PyDict_Clear((PyObject *) self->data);
+  mapping_version++;
 }
 
 static PyObject * mapping_clear(PyBlockMapping *self)
@@ -242,9 +259,8 @@ finally:
 }
 
 static PyObject * mapping_data_getter(PyBlockMapping *self, void *closure) {
-  PyObject * toret = (PyObject *) self->data;
-  Py_XINCREF(toret);
-  return toret;
+  // Read-only view, such that all modifications go through the mapping methods, which bump mapping_version
+  return PyDictProxy_New((PyObject *) self->data);
 }
 
 
@@ -280,6 +296,7 @@ static int mapping_init(PyBlockMapping *self, PyObject *args, PyObject *kwds)
       Py_INCREF(data_);
       Py_CLEAR(self->data);
       self->data = data_;
+      mapping_version++;
     }
     else if (PyBlockMapping_Update(self, data) != 0) goto except;
   }
@@ -352,7 +369,7 @@ static PySequenceMethods PyBlockMapping_as_sequence = {
 };
 
 static PyGetSetDef PyBlockMapping_properties[] = {
-  {"data", (getter) mapping_data_getter, NULL, "Data dictionary", NULL},
+  {"data", (getter) mapping_data_getter, NULL, "Read-only view of the data dictionary", NULL},
   {NULL}
 };
 
@@ -16,6 +16,10 @@ extern PyTypeObject PyBlockMappingType;
 
 #define PyBlockMapping_Check(op) PyObject_TypeCheck(op, &PyBlockMappingType)
 
+#define PyBlockMapping_IsEmpty(op) (PyDict_GET_SIZE((PyObject *) ((PyBlockMapping *) (op))->data) == 0)
+
+unsigned long long PyBlockMapping_Version(void);
+
 PyBlockMapping * PyBlockMapping_New(void);
 
 PyBlockMapping * PyBlockMapping_Copy(PyBlockMapping *self);
@@ -4,16 +4,42 @@
 #define DATABLOCK_MODULE
 #include "blockmodule.h"
 
-#define MAKE_TUPLE(__name)\
-  {\
-    Py_INCREF(__name);\
-    if (!PyTuple_Check(__name)) {\
-      __name = Py_BuildValue("(N)", __name);\
-      if (__name == NULL) {\
-        goto except;\
-      }\
-    }\
-  }\
+
+static int datablock_parse_fastcall(const char *fname, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames,
+                                    const char * const *kwlist, Py_ssize_t nrequired, PyObject **parsed)
+{
+  // Fill parsed (NULL-initialised, borrowed references) with METH_FASTCALL | METH_KEYWORDS arguments, following kwlist (NULL-terminated)
+  // Return 0 on success, -1 on error (TypeError)
+  Py_ssize_t nmax = 0, iarg = 0, ikw = 0, nkw = (kwnames == NULL) ? 0 : PyTuple_GET_SIZE(kwnames);
+  while (kwlist[nmax] != NULL) nmax++;
+  if (nargs > nmax) {
+    PyErr_Format(PyExc_TypeError, "%s() takes at most %zd positional arguments (%zd given)", fname, nmax, nargs);
+    return -1;
+  }
+  for (iarg = 0; iarg < nargs; iarg++) parsed[iarg] = args[iarg];
+  for (ikw = 0; ikw < nkw; ikw++) {
+    PyObject *kwname = PyTuple_GET_ITEM(kwnames, ikw);
+    for (iarg = 0; iarg < nmax; iarg++) {
+      if (PyUnicode_CompareWithASCIIString(kwname, kwlist[iarg]) == 0) break;
+    }
+    if (iarg == nmax) {
+      PyErr_Format(PyExc_TypeError, "%s() got an unexpected keyword argument '%S'", fname, kwname);
+      return -1;
+    }
+    if (parsed[iarg] != NULL) {
+      PyErr_Format(PyExc_TypeError, "%s() got multiple values for argument '%s'", fname, kwlist[iarg]);
+      return -1;
+    }
+    parsed[iarg] = args[nargs + ikw];
+  }
+  for (iarg = 0; iarg < nrequired; iarg++) {
+    if (parsed[iarg] == NULL) {
+      PyErr_Format(PyExc_TypeError, "%s() missing required argument '%s'", fname, kwlist[iarg]);
+      return -1;
+    }
+  }
+  return 0;
+}
 
 
 PyObject * PyDataBlock_Sections(PyDataBlock *self)
@@ -48,67 +74,325 @@ finally:
   return toret;
 }
 
-PyObject * datablock_keys(PyDataBlock *self, PyObject *args, PyObject *kwds)
+#if PY_VERSION_HEX >= 0x030D0000
+#define datablock_lookup_attr PyObject_GetOptionalAttr
+#else
+#define datablock_lookup_attr _PyObject_LookupAttr
+#endif
+
+static PyObject *copy_hook_name = NULL; // "_copy_if_datablock_copy", set in PyInit_block
+static PyObject *common_sections = NULL; // tuple of pypescript.syntax.common_sections, see datablock_common_sections
+
+static PyObject * datablock_common_sections(void)
+{
+  // Return borrowed reference to the tuple of common sections, default for add_sections and nocopy
+  // pypescript.syntax is imported on first call, as it is not available when this module is initialised
+  PyObject *syntax = NULL, *sections = NULL;
+  if (common_sections != NULL) return common_sections;
+  syntax = PyImport_ImportModule("pypescript.syntax");
+  if (syntax == NULL) goto finally;
+  sections = PyObject_GetAttrString(syntax, "common_sections");
+  if (sections == NULL) goto finally;
+  common_sections = PySequence_Tuple(sections);
+finally:
+  Py_XDECREF(syntax);
+  Py_XDECREF(sections);
+  return common_sections;
+}
+
+static int datablock_has_copy_hook(PyObject *value)
 {
-  static char *kwlist[] = {"section", NULL};
-  PyObject *section = NULL, *section_data = NULL;
-  PyObject *keys = NULL, *iter_sections = NULL, *sections = NULL, *iter_names = NULL, *name = NULL, *item = NULL;
-  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|U", kwlist, &section))
-    return NULL;
+  // Return 1 if value should be copied when DataBlock is copied (attribute _copy_if_datablock_copy), 0 if not, -1 on error
+  int toret = 0;
+  PyObject *attr = NULL;
+  if (PyLong_CheckExact(value) || PyFloat_CheckExact(value) || PyUnicode_CheckExact(value) || PyBool_Check(value) || (value == Py_None))
+    return toret;
+  toret = datablock_lookup_attr(value, copy_hook_name, &attr);
+  if (toret <= 0) return toret;
+  toret = PyObject_IsTrue(attr);
+  Py_DECREF(attr);
+  return toret;
+}
 
-  if (section != NULL) {
-    sections = Py_BuildValue("[O]",section); // raises error if NULL
-    if (sections == NULL) goto except;
+static int datablock_mark(PyObject **set, PyObject *section)
+{
+  if (*set == NULL) {
+    *set = PySet_New(NULL);
+    if (*set == NULL) return -1;
   }
-  else {
-    sections = PyDataBlock_Sections(self);
-    if (sections == NULL) {
-      PyErr_SetString(PyExc_TypeError,"Failed to get sections");
-      goto except;
-    }
+  return PySet_Add(*set, section);
+}
+
+static int datablock_is_marked(PyObject *set, PyObject *section)
+{
+  if ((set == NULL) || (PySet_GET_SIZE(set) == 0)) return 0;
+  return PySet_Contains(set, section);
+}
+
+static int datablock_unmark(PyObject *set, PyObject *section)
+{
+  if ((set == NULL) || (PySet_GET_SIZE(set) == 0)) return 0;
+  return PySet_Discard(set, section) < 0 ? -1 : 0;
+}
+
+static int datablock_alias_marks(PyObject **set, PyObject **other)
+{
+  // Make set the same object as other, for DataBlock instances sharing the same data dictionary
+  if (*other == NULL) {
+    *other = PySet_New(NULL);
+    if (*other == NULL) return -1;
   }
+  Py_INCREF(*other);
+  Py_XSETREF(*set, *other);
+  return 0;
+}
 
-  keys = PyList_New(0);
-  if (keys == NULL) {
-    PyErr_SetString(PyExc_TypeError,"Failed to create list");
-    goto except;
+static int datablock_section_has_copy_hook(PyObject *item)
+{
+  // Return 1 if any value of item (dictionary) has the _copy_if_datablock_copy hook, 0 if not, -1 on error
+  Py_ssize_t position = 0;
+  PyObject *name, *value;
+  int hook = 0;
+  while (PyDict_Next(item, &position, &name, &value)) {
+    hook = datablock_has_copy_hook(value);
+    if (hook != 0) return hook;
   }
-  iter_sections = PyObject_GetIter(sections); // raises error if NULL
-  if (iter_sections == NULL) goto except;
-  while ((section = PyIter_Next(iter_sections))) {
-    section_data = PyDataBlock_GetSection(self, section, NULL); // new reference
-    if (section_data == NULL) {Py_XDECREF(section); goto except;};
-    iter_names = PyObject_GetIter(section_data);
-    if (iter_names == NULL) {Py_XDECREF(section_data); Py_XDECREF(section); goto except;};
-    while ((name = PyIter_Next(iter_names))) {
-      item = Py_BuildValue("(ON)", section, name); // raises error if NULL, N steals reference
-      if (item == NULL) {Py_XDECREF(name); Py_XDECREF(iter_names); Py_XDECREF(section_data); Py_XDECREF(section); goto except;};
-      if (PyList_Append(keys, item) != 0) {
-        PyErr_SetString(PyExc_TypeError,"Failed to add item to list");
-        Py_XDECREF(item); Py_XDECREF(iter_names); Py_XDECREF(section_data); Py_XDECREF(section);
-        goto except;
-      }
-      Py_XDECREF(item);
-      //Py_XDECREF(name);
+  return hook;
+}
+
+static PyObject * datablock_copy_section(PyObject *item, int scan)
+{
+  // Return new dictionary, shallow copy of item, with values having the _copy_if_datablock_copy hook copied if scan
+  Py_ssize_t position = 0;
+  PyObject *toret = NULL, *name, *value, *value_copy = NULL;
+  int hook = 0;
+  toret = PyDict_Copy(item);
+  if ((toret == NULL) || !scan) return toret;
+  while (PyDict_Next(item, &position, &name, &value)) {
+    hook = datablock_has_copy_hook(value);
+    if (hook < 0) goto except;
+    if (!hook) continue;
+    value_copy = PyObject_CallMethod(value, "copy", NULL);
+    if (value_copy == NULL) goto except;
+    if (PyDict_SetItem(toret, name, value_copy) != 0) goto except;
+    Py_CLEAR(value_copy);
+  }
+  goto finally;
+except:
+  Py_CLEAR(toret);
+finally:
+  Py_XDECREF(value_copy);
+  return toret;
+}
+
+static int datablock_own_section(PyDataBlock *self, PyObject *section)
+{
+  // Make sure the dictionary of section is private to self, i.e. can be modified in place
+  // If it is shared with copies, it is replaced by a (shallow) copy, unless self holds the only reference to it
+  int toret = 0;
+  PyObject *item = NULL, *item_copy = NULL;
+  toret = datablock_is_marked(self->shared, section);
+  if (toret <= 0) return toret;
+  toret = 0;
+  item = PyDict_GetItemWithError((PyObject *) self->data, section);
+  if (item == NULL) {
+    if (PyErr_Occurred()) goto except;
+  }
+  else if (Py_REFCNT(item) > 1) {
+    item_copy = PyDict_Copy(item);
+    if (item_copy == NULL) goto except;
+    if (PyDict_SetItem((PyObject *) self->data, section, item_copy) != 0) goto except;
+  }
+  if (datablock_unmark(self->shared, section) != 0) goto except;
+  goto finally;
+except:
+  toret = -1;
+finally:
+  Py_XDECREF(item_copy);
+  return toret;
+}
+
+static int datablock_own_sections(PyDataBlock *self)
+{
+  // Make all sections private to self, and to be scanned on copy, as the data dictionary is exposed
+  Py_ssize_t position = 0;
+  PyObject *section, *item;
+  while (PyDict_Next((PyObject *) self->data, &position, &section, &item)) {
+    if (datablock_own_section(self, section) != 0) return -1;
+    if (datablock_mark(&self->scan, section) != 0) return -1;
+  }
+  return 0;
+}
+
+static int datablock_share_section(PyDataBlock *self, PyDataBlock *other, PyObject *section, PyObject *item)
+{
+  // Add section (dictionary item) of other to self, to be copied on write
+  // Dictionaries referenced outside self and other (e.g. nocopy sections, obtained by get(section), or through the data attribute)
+  // are copied right away
+  int toret = 0, shared = 0, scan = 0, exposed = 0;
+  PyObject *item_copy = NULL;
+  shared = datablock_is_marked(other->shared, section);
+  if (shared < 0) goto except;
+  exposed = datablock_is_marked(other->exposed, Py_None);
+  if (exposed < 0) goto except;
+  scan = datablock_is_marked(other->scan, section);
+  if (scan < 0) goto except;
+  if (scan || exposed) {
+    scan = datablock_section_has_copy_hook(item);
+    if (scan < 0) goto except;
+    // No one else can add values with the hook: no need to scan it next time
+    if (!scan && !exposed && (shared || (Py_REFCNT(item) == 1)) && (datablock_unmark(other->scan, section) != 0)) goto except;
+  }
+  if (scan || exposed || (!shared && (Py_REFCNT(item) > 1))) {
+    item_copy = datablock_copy_section(item, scan);
+    if (item_copy == NULL) goto except;
+    if (PyDict_SetItem((PyObject *) self->data, section, item_copy) != 0) goto except;
+    if (datablock_unmark(self->shared, section) != 0) goto except;
+    if (scan && (datablock_mark(&self->scan, section) != 0)) goto except;
+    goto finally;
+  }
+  if (PyDict_SetItem((PyObject *) self->data, section, item) != 0) goto except;
+  if (datablock_mark(&self->shared, section) != 0) goto except;
+  if (datablock_mark(&other->shared, section) != 0) goto except;
+  goto finally;
+except:
+  toret = -1;
+finally:
+  Py_XDECREF(item_copy);
+  return toret;
+}
+
+static int datablock_resolve(PyDataBlock *self, PyObject *section, PyObject *name, PyObject **true_section, PyObject **true_name)
+{
+  // Return borrowed references to (true_section, true_name), as given by self->mapping
+  // Resolutions are cached in self->mapping_cache, such that no allocation is needed for already-resolved keys
+  // self->mapping_cache must be released (Py_CLEAR) whenever self->mapping is changed, as it may be shared with copies
+  int toret = 1;
+  PyObject *names = NULL, *resolved = NULL;
+  if (PyBlockMapping_IsEmpty(self->mapping)) {
+    *true_section = section;
+    *true_name = name;
+    return toret;
+  }
+  if (self->mapping_cache == NULL) {
+    self->mapping_cache = (PyDictObject *) PyDict_New();
+    if (self->mapping_cache == NULL) goto except;
+  }
+  else if (self->mapping_cache_version != PyBlockMapping_Version()) {
+    PyDict_Clear((PyObject *) self->mapping_cache);
+  }
+  self->mapping_cache_version = PyBlockMapping_Version();
+  names = PyDict_GetItemWithError((PyObject *) self->mapping_cache, section);
+  if (names != NULL) {
+    resolved = PyDict_GetItemWithError(names, name);
+    if (resolved != NULL) {
+      *true_section = PyTuple_GET_ITEM(resolved, 0);
+      *true_name = PyTuple_GET_ITEM(resolved, 1);
+      return toret;
     }
-    Py_XDECREF(iter_names); Py_XDECREF(section_data); Py_XDECREF(section);
   }
-  //assert(!PyErr_Occurred());
+  if (PyErr_Occurred()) goto except;
+  if (!PyBlockMapping_ParseSectionName(self->mapping, section, name, true_section, true_name)) goto except;
+  if (names == NULL) {
+    names = PyDict_New();
+    if (names == NULL) goto except;
+    toret = PyDict_SetItem((PyObject *) self->mapping_cache, section, names) == 0;
+    Py_DECREF(names); // kept alive by self->mapping_cache
+    if (!toret) goto except;
+  }
+  resolved = PyTuple_Pack(2, *true_section, *true_name);
+  if (resolved == NULL) goto except;
+  toret = PyDict_SetItem(names, name, resolved) == 0;
+  Py_DECREF(resolved); // kept alive by self->mapping_cache
+  if (!toret) goto except;
+  *true_section = PyTuple_GET_ITEM(resolved, 0);
+  *true_name = PyTuple_GET_ITEM(resolved, 1);
   goto finally;
 except:
-  //assert(PyErr_Occurred());
-  Py_XDECREF(keys);
-  keys = NULL;
+  toret = 0;
 finally:
-  Py_XDECREF(sections);
-  Py_XDECREF(iter_sections);
-  return keys;
+  return toret;
 }
 
+static int datablock_trace(PyDataBlock *self, PyObject *section, PyObject *name, long flag)
+{
+  // Add flag to the access flags of (section, name) in self->trace
+  long flags = 0;
+  int toret = 0;
+  PyObject *names = NULL, *value = NULL;
+  names = PyDict_GetItemWithError(self->trace, section);
+  if (names == NULL) {
+    if (PyErr_Occurred()) goto except;
+    names = PyDict_New();
+    if (names == NULL) goto except;
+    toret = PyDict_SetItem(self->trace, section, names);
+    Py_DECREF(names); // kept alive by self->trace
+    if (toret != 0) goto except;
+  }
+  value = PyDict_GetItemWithError(names, name);
+  if (value != NULL) {
+    flags = PyLong_AsLong(value);
+    if ((flags == -1) && PyErr_Occurred()) goto except;
+    if ((flags & flag) == flag) goto finally;
+  }
+  else if (PyErr_Occurred()) goto except;
+  value = PyLong_FromLong(flags | flag);
+  if (value == NULL) goto except;
+  toret = PyDict_SetItem(names, name, value);
+  Py_DECREF(value);
+  goto finally;
+except:
+  toret = -1;
+finally:
+  return toret;
+}
+
+// A single branch if not tracing
+#define DATABLOCK_TRACE(self, section, name, flag) (((self)->trace == NULL) ? 0 : datablock_trace(self, section, name, flag))
+
+static int datablock_trace_sections(PyDataBlock *self, PyObject *section, long flag)
+{
+  // Add flag to the access flags of whole section, or of all sections if section is NULL
+  Py_ssize_t position = 0;
+  PyObject *item;
+  if (self->trace == NULL) return 0;
+  if (section != NULL) return datablock_trace(self, section, Py_None, flag);
+  while (PyDict_Next((PyObject *) self->data, &position, &section, &item)) {
+    if (datablock_trace(self, section, Py_None, flag) != 0) return -1;
+  }
+  return 0;
+}
+
+static int datablock_dirty(PyDataBlock *self, PyObject *section, PyObject *name)
+{
+  // Add name to the set of modified names of section in self->dirty
+  int toret = 0;
+  PyObject *names = NULL;
+  names = PyDict_GetItemWithError(self->dirty, section);
+  if (names == NULL) {
+    if (PyErr_Occurred()) goto except;
+    names = PySet_New(NULL);
+    if (names == NULL) goto except;
+    toret = PyDict_SetItem(self->dirty, section, names);
+    Py_DECREF(names); // kept alive by self->dirty
+    if (toret != 0) goto except;
+  }
+  toret = PySet_Add(names, name);
+  goto finally;
+except:
+  toret = -1;
+finally:
+  return toret;
+}
+
+// A single branch if not tracking modifications
+#define DATABLOCK_DIRTY(self, section, name) (((self)->dirty == NULL) ? 0 : datablock_dirty(self, section, name))
+
 static PyObject * PyDataBlock_GetValue(PyDataBlock *self, PyObject *section, PyObject *name, PyObject *default_value)
 {
   PyObject *toret = NULL, *true_section = NULL, *true_name = NULL, *item = NULL;
-  if (!PyBlockMapping_ParseSectionName(self->mapping, section, name, &true_section, &true_name)) goto except;
+  if (!datablock_resolve(self, section, name, &true_section, &true_name)) goto except;
+  if (DATABLOCK_TRACE(self, true_section, true_name, DATABLOCK_TRACE_GET) != 0) goto except;
 
   if ((default_value != NULL) && (PyDataBlock_HasSection(self, true_section) != 1)) {
     toret = default_value;
@@ -140,7 +424,8 @@ static int PyDataBlock_HasValue(PyDataBlock *self, PyObject *section, PyObject *
 {
   int toret = 1;
   PyObject *true_section = NULL, *true_name = NULL, *item = NULL;
-  if (!PyBlockMapping_ParseSectionName(self->mapping, section, name, &true_section, &true_name)) goto except;
+  if (!datablock_resolve(self, section, name, &true_section, &true_name)) goto except;
+  if (DATABLOCK_TRACE(self, true_section, true_name, DATABLOCK_TRACE_HAS) != 0) goto except;
   toret = PyDataBlock_HasSection(self, true_section);
   if (toret != 1) goto finally;
   item = PyDataBlock_GetSection(self, true_section, NULL);
@@ -155,20 +440,23 @@ finally:
 }
 
 
-static PyObject* datablock_has(PyDataBlock *self, PyObject *args, PyObject *kwds)
+static PyObject * datablock_has(PyDataBlock *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames)
 {
   int contains = 0;
-  static char *kwlist[] = {"section", "name", NULL};
-  PyObject *section = NULL, *name = NULL;
+  static const char * const kwlist[] = {"section", "name", NULL};
+  PyObject *parsed[2] = {NULL, NULL};
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist, &section, &name))
-    return NULL;
-
-  if (name == NULL) {
-    contains = PyDataBlock_HasSection(self, section);
+  if ((kwnames == NULL) && (nargs == 2)) {
+    contains = PyDataBlock_HasValue(self, args[0], args[1]);
     goto finally;
   }
-  contains = PyDataBlock_HasValue(self, section, name);
+  if (datablock_parse_fastcall("has", args, nargs, kwnames, kwlist, 1, parsed) != 0) return NULL;
+  if (parsed[1] == NULL) {
+    if (DATABLOCK_TRACE(self, parsed[0], Py_None, DATABLOCK_TRACE_HAS) != 0) return NULL;
+    contains = PyDataBlock_HasSection(self, parsed[0]);
+    goto finally;
+  }
+  contains = PyDataBlock_HasValue(self, parsed[0], parsed[1]);
   goto finally;
 finally:
   if (contains != 1) Py_RETURN_FALSE;
@@ -176,91 +464,381 @@ finally:
 }
 
 
-static int datablock_contains(PyObject *self, PyObject *args)
+static int datablock_contains(PyDataBlock *self, PyObject *key)
 {
-  int toret = 1;
-  MAKE_TUPLE(args);
-
-  PyObject *section = NULL, *name = NULL;
-  if (PyTuple_Size(args) == 1) {
-    if (!PyArg_ParseTuple(args, "O", &section)) goto except;
-    toret = PyDataBlock_HasSection((PyDataBlock *) self, section);
-    goto finally;
+  // key is section, or (section, name)
+  if (PyTuple_Check(key) && (PyTuple_GET_SIZE(key) == 2)) return PyDataBlock_HasValue(self, PyTuple_GET_ITEM(key, 0), PyTuple_GET_ITEM(key, 1));
+  if (PyTuple_Check(key) && (PyTuple_GET_SIZE(key) == 1)) key = PyTuple_GET_ITEM(key, 0);
+  if (!PyTuple_Check(key)) {
+    if (DATABLOCK_TRACE(self, key, Py_None, DATABLOCK_TRACE_HAS) != 0) return -1;
+    return PyDataBlock_HasSection(self, key);
   }
-  if (!PyArg_ParseTuple(args, "OO", &section, &name)) goto except;
-  toret = PyDataBlock_HasValue((PyDataBlock *) self, section, name);
-  goto finally;
-except:
-  toret = -1;
-finally:
-  Py_XDECREF(args);
-  return toret;
+  PyErr_SetString(PyExc_TypeError, "Key must be section or (section, name)");
+  return -1;
 }
 
-PyObject * datablock_get(PyDataBlock *self, PyObject *args, PyObject *kwds)
+static PyObject * datablock_get_section(PyDataBlock *self, PyObject *section, PyObject *default_value)
+{
+  // The section dictionary may be modified by the caller
+  if (DATABLOCK_TRACE(self, section, Py_None, DATABLOCK_TRACE_GET | DATABLOCK_TRACE_SET) != 0) return NULL;
+  if (datablock_own_section(self, section) != 0) return NULL;
+  if ((PyDataBlock_HasSection(self, section) == 1) && (datablock_mark(&self->scan, section) != 0)) return NULL;
+  return PyDataBlock_GetSection(self, section, default_value);
+}
+
+static PyObject * datablock_get(PyDataBlock *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames)
 {
   // Return new references
-  PyObject *section = NULL, *name = NULL, *default_value = NULL;
-  static char *kwlist[] = {"section", "name", "default", NULL};
-  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OO", kwlist, &section, &name, &default_value))
-    return NULL;
+  static const char * const kwlist[] = {"section", "name", "default", NULL};
+  PyObject *parsed[3] = {NULL, NULL, NULL};
 
-  if (name == NULL) return PyDataBlock_GetSection(self, section, default_value);
-  return PyDataBlock_GetValue(self, section, name, default_value);
+  if ((kwnames == NULL) && (nargs == 2)) return PyDataBlock_GetValue(self, args[0], args[1], NULL);
+  if (datablock_parse_fastcall("get", args, nargs, kwnames, kwlist, 1, parsed) != 0) return NULL;
+  if (parsed[1] == NULL) return datablock_get_section(self, parsed[0], parsed[2]);
+  return PyDataBlock_GetValue(self, parsed[0], parsed[1], parsed[2]);
 }
 
 PyObject * PyDataBlock_GetItem(PyDataBlock *self, PyObject *key)
 {
-  MAKE_TUPLE(key);
-  PyObject *toret = datablock_get(self, key, NULL);
-  goto finally;
-except:
-  toret = NULL;
-finally:
-  Py_XDECREF(key);
-  return toret;
+  // key is section, or (section, name), or (section, name, default)
+  if (!PyTuple_Check(key)) return datablock_get_section(self, key, NULL);
+  if (PyTuple_GET_SIZE(key) == 2) return PyDataBlock_GetValue(self, PyTuple_GET_ITEM(key, 0), PyTuple_GET_ITEM(key, 1), NULL);
+  return datablock_get(self, &PyTuple_GET_ITEM(key, 0), PyTuple_GET_SIZE(key), NULL);
 }
 
-PyObject * datablock_items(PyDataBlock *self, PyObject *args, PyObject *kwds)
+// Lazy iterators and views over (section, name) keys, ((section, name), value) items and values
+// Nested dictionaries are walked directly, without mapping
+
+#define DATABLOCK_KEYS 0
+#define DATABLOCK_ITEMS 1
+#define DATABLOCK_VALUES 2
+
+typedef struct {
+  PyObject_HEAD
+  PyDictObject *data; // data dictionary of the DataBlock instance, NULL when exhausted or restricted to one section
+  PyObject *section; // current section and its dictionary
+  PyObject *section_data;
+  Py_ssize_t position; // positions in data and section_data, for PyDict_Next
+  Py_ssize_t section_position;
+  Py_ssize_t size; // sizes of data and section_data when iteration started, size is -1 if any changed
+  Py_ssize_t section_size;
+  int kind; // DATABLOCK_KEYS, DATABLOCK_ITEMS or DATABLOCK_VALUES
+} PyDataBlockIterator;
+
+static PyTypeObject PyDataBlockIteratorType;
+
+static PyObject * datablock_iter_new(PyDataBlock *self, PyObject *section, int kind)
 {
-  PyObject *keys = NULL, *key, *value, *item, *iter_keys = NULL, *items = PyList_New(0);
-  if (items == NULL) goto except;
-  keys = datablock_keys(self, args, kwds);
-  if (keys == NULL) goto except;
-  iter_keys = PyObject_GetIter(keys);
-  if (iter_keys == NULL) goto except;
-  while ((key = PyIter_Next(iter_keys))) {
-    value = PyDataBlock_GetItem(self, key);
-    if (value == NULL) goto except;
-    item = Py_BuildValue("(NN)", key, value); // N steals reference
-    if (item == NULL) goto except;
-    if (PyList_Append(items, item) != 0) {
-      PyErr_SetString(PyExc_TypeError,"Failed to add item to list");
-      goto except;
+  // Return new iterator over self, restricted to section if not NULL
+  PyObject *section_data = NULL;
+  PyDataBlockIterator *toret = NULL;
+  if (datablock_trace_sections(self, section, (kind == DATABLOCK_KEYS) ? DATABLOCK_TRACE_HAS : DATABLOCK_TRACE_GET) != 0) return NULL;
+  if (section != NULL) {
+    section_data = PyDict_GetItemWithError((PyObject *) self->data, section);
+    if (section_data == NULL) {
+      if (!PyErr_Occurred()) PyErr_Format(PyExc_KeyError, "Section %S does not exist", section);
+      return NULL;
     }
-    Py_XDECREF(item);
-    //Py_XDECREF(value);
-    //Py_XDECREF(key);
   }
-  goto finally;
-except:
-  Py_XDECREF(items);
-  items = NULL;
+  toret = PyObject_GC_New(PyDataBlockIterator, &PyDataBlockIteratorType);
+  if (toret == NULL) return NULL;
+  toret->data = NULL;
+  toret->size = 0;
+  if (section == NULL) {
+    Py_INCREF(self->data);
+    toret->data = self->data;
+    toret->size = PyDict_GET_SIZE(self->data);
+  }
+  Py_XINCREF(section);
+  toret->section = section;
+  Py_XINCREF(section_data);
+  toret->section_data = section_data;
+  toret->position = 0;
+  toret->section_position = 0;
+  toret->section_size = (section_data != NULL) ? PyDict_Size(section_data) : 0;
+  toret->kind = kind;
+  PyObject_GC_Track(toret);
+  return (PyObject *) toret;
+}
+
+static PyObject * datablock_iter(PyDataBlock *self)
+{
+  return datablock_iter_new(self, NULL, DATABLOCK_KEYS);
+}
+
+static PyObject * datablockiter_next(PyDataBlockIterator *self)
+{
+  // Return new reference to the next key, item or value, NULL when exhausted
+  PyObject *section = NULL, *section_data = NULL, *name = NULL, *value = NULL, *key = NULL;
+  if ((self->data == NULL) && (self->section_data == NULL)) return NULL;
+  if ((self->size < 0) || ((self->data != NULL) && (PyDict_GET_SIZE(self->data) != self->size))
+      || ((self->section_data != NULL) && (PyDict_GET_SIZE(self->section_data) != self->section_size))) {
+    self->size = -1;
+    PyErr_SetString(PyExc_RuntimeError, "DataBlock changed size during iteration");
+    return NULL;
+  }
+  while (1) {
+    if ((self->section_data != NULL) && PyDict_Next(self->section_data, &self->section_position, &name, &value)) {
+      if (self->kind == DATABLOCK_VALUES) {
+        Py_INCREF(value);
+        return value;
+      }
+      key = PyTuple_Pack(2, self->section, name);
+      if ((key == NULL) || (self->kind == DATABLOCK_KEYS)) return key;
+      return Py_BuildValue("(NO)", key, value);
+    }
+    Py_CLEAR(self->section);
+    Py_CLEAR(self->section_data);
+    if ((self->data == NULL) || !PyDict_Next((PyObject *) self->data, &self->position, &section, &section_data)) break;
+    if (!PyDict_Check(section_data)) continue;
+    // Keep references, as the section dictionary may be replaced in data (copy-on-write)
+    Py_INCREF(section);
+    self->section = section;
+    Py_INCREF(section_data);
+    self->section_data = section_data;
+    self->section_position = 0;
+    self->section_size = PyDict_GET_SIZE(section_data);
+  }
+  Py_CLEAR(self->data);
+  return NULL;
+}
+
+static int datablockiter_traverse(PyDataBlockIterator *self, visitproc visit, void *arg)
+{
+  Py_VISIT(self->data);
+  Py_VISIT(self->section);
+  Py_VISIT(self->section_data);
+  return 0;
+}
+
+static void datablockiter_dealloc(PyDataBlockIterator *self)
+{
+  PyObject_GC_UnTrack(self);
+  Py_CLEAR(self->data);
+  Py_CLEAR(self->section);
+  Py_CLEAR(self->section_data);
+  PyObject_GC_Del(self);
+}
+
+static PyTypeObject PyDataBlockIteratorType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  .tp_name = "block.DataBlockIterator",
+  .tp_doc = "Iterator over DataBlock keys, items or values",
+  .tp_basicsize = sizeof(PyDataBlockIterator),
+  .tp_itemsize = 0,
+  .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+  .tp_dealloc = (destructor) datablockiter_dealloc,
+  .tp_traverse = (traverseproc) datablockiter_traverse,
+  .tp_iter = PyObject_SelfIter,
+  .tp_iternext = (iternextfunc) datablockiter_next
+};
+
+
+typedef struct {
+  PyObject_HEAD
+  PyDataBlock *block;
+  PyObject *section; // if not NULL, view is restricted to this section
+  int kind; // DATABLOCK_KEYS, DATABLOCK_ITEMS or DATABLOCK_VALUES
+} PyDataBlockView;
+
+static PyTypeObject PyDataBlockKeysViewType;
+static PyTypeObject PyDataBlockItemsViewType;
+static PyTypeObject PyDataBlockValuesViewType;
+
+#define PyDataBlockView_Check(op) ((Py_TYPE(op) == &PyDataBlockKeysViewType) || (Py_TYPE(op) == &PyDataBlockItemsViewType) || (Py_TYPE(op) == &PyDataBlockValuesViewType))
+
+static PyObject * datablock_view_new(PyDataBlock *self, PyObject *args, PyObject *kwds, int kind)
+{
+  // Return new view of self, restricted to section if provided (which must exist)
+  static char *kwlist[] = {"section", NULL};
+  PyObject *section = NULL;
+  PyTypeObject *type = (kind == DATABLOCK_KEYS) ? &PyDataBlockKeysViewType : (kind == DATABLOCK_ITEMS) ? &PyDataBlockItemsViewType : &PyDataBlockValuesViewType;
+  PyDataBlockView *toret = NULL;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|U", kwlist, &section)) return NULL;
+  if ((section != NULL) && (PyDataBlock_HasSection(self, section) != 1)) {
+    if (!PyErr_Occurred()) PyErr_Format(PyExc_KeyError, "Section %S does not exist", section);
+    return NULL;
+  }
+  toret = PyObject_GC_New(PyDataBlockView, type);
+  if (toret == NULL) return NULL;
+  Py_INCREF(self);
+  toret->block = self;
+  Py_XINCREF(section);
+  toret->section = section;
+  toret->kind = kind;
+  PyObject_GC_Track(toret);
+  return (PyObject *) toret;
+}
+
+static PyObject * datablock_keys(PyDataBlock *self, PyObject *args, PyObject *kwds)
+{
+  return datablock_view_new(self, args, kwds, DATABLOCK_KEYS);
+}
+
+static PyObject * datablock_items(PyDataBlock *self, PyObject *args, PyObject *kwds)
+{
+  return datablock_view_new(self, args, kwds, DATABLOCK_ITEMS);
+}
+
+static PyObject * datablock_values(PyDataBlock *self, PyObject *args, PyObject *kwds)
+{
+  return datablock_view_new(self, args, kwds, DATABLOCK_VALUES);
+}
+
+static PyObject * datablockview_iter(PyDataBlockView *self)
+{
+  return datablock_iter_new(self->block, self->section, self->kind);
+}
+
+static Py_ssize_t datablockview_len(PyDataBlockView *self)
+{
+  // Number of (section, name) entries, summing over the number of sections if not restricted to one
+  Py_ssize_t toret = 0, position = 0;
+  PyObject *section, *section_data;
+  if (datablock_trace_sections(self->block, self->section, DATABLOCK_TRACE_HAS) != 0) return -1;
+  if (self->section != NULL) {
+    section_data = PyDict_GetItemWithError((PyObject *) self->block->data, self->section);
+    if (section_data == NULL) return PyErr_Occurred() ? -1 : 0;
+    return PyDict_Size(section_data);
+  }
+  while (PyDict_Next((PyObject *) self->block->data, &position, &section, &section_data)) {
+    if (PyDict_Check(section_data)) toret += PyDict_GET_SIZE(section_data);
+  }
+  return toret;
+}
+
+static PyObject * datablockview_lookup(PyDataBlockView *self, PyObject *key)
+{
+  // Return borrowed reference to the value of (section, name) key, NULL if not in self (with an exception set on error only)
+  PyObject *section_data = NULL;
+  if (!PyTuple_CheckExact(key) || (PyTuple_GET_SIZE(key) != 2)) return NULL;
+  if (self->section != NULL) {
+    int equal = PyObject_RichCompareBool(PyTuple_GET_ITEM(key, 0), self->section, Py_EQ);
+    if (equal <= 0) return NULL;
+  }
+  if (DATABLOCK_TRACE(self->block, PyTuple_GET_ITEM(key, 0), PyTuple_GET_ITEM(key, 1), (self->kind == DATABLOCK_KEYS) ? DATABLOCK_TRACE_HAS : DATABLOCK_TRACE_GET) != 0) return NULL;
+  section_data = PyDict_GetItemWithError((PyObject *) self->block->data, PyTuple_GET_ITEM(key, 0));
+  if ((section_data == NULL) || !PyDict_Check(section_data)) return NULL;
+  return PyDict_GetItemWithError(section_data, PyTuple_GET_ITEM(key, 1));
+}
+
+static int datablockview_contains(PyDataBlockView *self, PyObject *key)
+{
+  int toret = 0;
+  PyObject *value = NULL, *iter = NULL, *item = NULL;
+  if (self->kind == DATABLOCK_KEYS) {
+    value = datablockview_lookup(self, key);
+    if (value != NULL) return 1;
+    return PyErr_Occurred() ? -1 : 0;
+  }
+  if (self->kind == DATABLOCK_ITEMS) {
+    if (!PyTuple_Check(key) || (PyTuple_GET_SIZE(key) != 2)) return 0;
+    value = datablockview_lookup(self, PyTuple_GET_ITEM(key, 0));
+    if (value == NULL) return PyErr_Occurred() ? -1 : 0;
+    Py_INCREF(value);
+    toret = PyObject_RichCompareBool(value, PyTuple_GET_ITEM(key, 1), Py_EQ);
+    Py_DECREF(value);
+    return toret;
+  }
+  // Values: linear search, as for dict.values()
+  iter = datablockview_iter(self);
+  if (iter == NULL) return -1;
+  while ((toret == 0) && (item = PyIter_Next(iter))) {
+    toret = PyObject_RichCompareBool(item, key, Py_EQ);
+    Py_DECREF(item);
+  }
+  Py_DECREF(iter);
+  if ((toret == 0) && PyErr_Occurred()) toret = -1;
+  return toret;
+}
+
+static PyObject * datablockview_richcompare(PyDataBlockView *self, PyObject *other, int op)
+{
+  // Views compare equal to lists, tuples or views with the same elements in the same order
+  // (keys() and items() used to return lists)
+  PyObject *list = NULL, *other_list = NULL, *toret = NULL;
+  if (((op != Py_EQ) && (op != Py_NE)) || !(PyList_Check(other) || PyTuple_Check(other) || PyDataBlockView_Check(other)))
+    Py_RETURN_NOTIMPLEMENTED;
+  list = PySequence_List((PyObject *) self);
+  if (list == NULL) goto finally;
+  other_list = PySequence_List(other);
+  if (other_list == NULL) goto finally;
+  toret = PyObject_RichCompare(list, other_list, op);
 finally:
-  Py_XDECREF(keys);
-  Py_XDECREF(iter_keys);
-  return items;
+  Py_XDECREF(list);
+  Py_XDECREF(other_list);
+  return toret;
+}
+
+static PyObject * datablockview_repr(PyDataBlockView *self)
+{
+  PyObject *toret = NULL, *list = PySequence_List((PyObject *) self);
+  if (list == NULL) return NULL;
+  toret = PyUnicode_FromFormat("%s(%R)", strrchr(Py_TYPE(self)->tp_name, '.') + 1, list);
+  Py_DECREF(list);
+  return toret;
 }
 
+static int datablockview_traverse(PyDataBlockView *self, visitproc visit, void *arg)
+{
+  Py_VISIT(self->block);
+  Py_VISIT(self->section);
+  return 0;
+}
+
+static void datablockview_dealloc(PyDataBlockView *self)
+{
+  PyObject_GC_UnTrack(self);
+  Py_CLEAR(self->block);
+  Py_CLEAR(self->section);
+  PyObject_GC_Del(self);
+}
+
+static PySequenceMethods PyDataBlockView_as_sequence = {
+  .sq_length = (lenfunc) datablockview_len,
+  .sq_contains = (objobjproc) datablockview_contains
+};
+
+#define DATABLOCK_VIEW_TYPE(__type, __name, __doc)\
+  static PyTypeObject __type = {\
+    PyVarObject_HEAD_INIT(NULL, 0)\
+    .tp_name = "block." __name,\
+    .tp_doc = __doc,\
+    .tp_basicsize = sizeof(PyDataBlockView),\
+    .tp_itemsize = 0,\
+    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,\
+    .tp_dealloc = (destructor) datablockview_dealloc,\
+    .tp_traverse = (traverseproc) datablockview_traverse,\
+    .tp_as_sequence = &PyDataBlockView_as_sequence,\
+    .tp_richcompare = (richcmpfunc) datablockview_richcompare,\
+    .tp_iter = (getiterfunc) datablockview_iter,\
+    .tp_repr = (reprfunc) datablockview_repr\
+  };
+
+DATABLOCK_VIEW_TYPE(PyDataBlockKeysViewType, "DataBlockKeysView", "View on DataBlock (section, name) keys")
+DATABLOCK_VIEW_TYPE(PyDataBlockItemsViewType, "DataBlockItemsView", "View on DataBlock ((section, name), value) items")
+DATABLOCK_VIEW_TYPE(PyDataBlockValuesViewType, "DataBlockValuesView", "View on DataBlock values")
+
+
 int PyDataBlock_SetSection(PyDataBlock *self, PyObject *section, PyObject *value)
 {
-  int toret = 0;
+  int toret = 0, shared = 0, hook = 0;
   PyObject *item = NULL;
   if (!PyDict_Check(value)) {
     PyErr_SetString(PyExc_TypeError, "Value must be a dictionary");
     goto except;
   }
-  if (PyDataBlock_HasSection(self, section)) {
+  if (DATABLOCK_DIRTY(self, section, Py_None) != 0) goto except;
+  hook = datablock_section_has_copy_hook(value);
+  if (hook < 0) goto except;
+  if (hook && (datablock_mark(&self->scan, section) != 0)) goto except;
+  shared = datablock_is_marked(self->shared, section);
+  if (shared < 0) goto except;
+  if (shared) {
+    // No need to copy the dictionary shared with copies, as it is replaced right away
+    if (datablock_unmark(self->shared, section) != 0) goto except;
+  }
+  else if (PyDataBlock_HasSection(self, section)) {
     item = PyDataBlock_GetSection(self, section, NULL);
     if (item == NULL) goto except;
     if (item != value) {
@@ -284,11 +862,19 @@ static int PyDataBlock_SetValue(PyDataBlock *self, PyObject *section, PyObject *
 {
   int toret = 0;
   PyObject *true_section = NULL, *true_name = NULL, *item = NULL, *dict = NULL;
-  if (!PyBlockMapping_ParseSectionName(self->mapping, section, name, &true_section, &true_name)) goto except;
+  if (!datablock_resolve(self, section, name, &true_section, &true_name)) goto except;
+  if (DATABLOCK_TRACE(self, true_section, true_name, DATABLOCK_TRACE_SET) != 0) goto except;
+  if (DATABLOCK_DIRTY(self, true_section, true_name) != 0) goto except;
+  if (datablock_own_section(self, true_section) != 0) goto except;
   if (!PyDataBlock_HasSection(self, true_section)) {
     dict = PyDict_New();
     if (PyDataBlock_SetSection(self, true_section, dict) != 0) goto except;
   }
+  if (datablock_has_copy_hook(value)) {
+    // In case of error, mark the section anyway, such that the error is raised when copying
+    PyErr_Clear();
+    if (datablock_mark(&self->scan, true_section) != 0) goto except;
+  }
   item = PyDataBlock_GetSection(self, true_section, NULL);
   if (item == NULL) goto except;
   //printf("Ref set data 1 %d %d\n",Py_REFCNT(self),Py_REFCNT(value));
@@ -304,22 +890,21 @@ finally:
 }
 
 
-PyObject * datablock_set(PyDataBlock *self, PyObject *args)
+static PyObject * datablock_set(PyDataBlock *self, PyObject *const *args, Py_ssize_t nargs)
 {
   // Does not steal reference
   int toret = 0;
-  PyObject *section = NULL, *name = NULL, *value = NULL;
-  if (!PyArg_ParseTuple(args,"OO|O", &section, &name, &value)) return NULL;
-  if (value == NULL) {
-    value = name;
-    name = NULL;
+  if (nargs == 3) {
+    toret = PyDataBlock_SetValue(self, args[0], args[1], args[2]);
+    goto finally;
   }
-  if (name == NULL) {
-    toret = PyDataBlock_SetSection(self, section, value);
+  if (nargs == 2) {
+    toret = DATABLOCK_TRACE(self, args[0], Py_None, DATABLOCK_TRACE_SET);
+    if (toret == 0) toret = PyDataBlock_SetSection(self, args[0], args[1]);
     goto finally;
   }
-  toret = PyDataBlock_SetValue(self, section, name, value);
-  goto finally;
+  PyErr_Format(PyExc_TypeError, "set() takes 2 or 3 arguments (%zd given)", nargs);
+  return NULL;
 finally:
   if (toret == 0) Py_RETURN_NONE;
   return NULL;
@@ -328,6 +913,8 @@ finally:
 void PyDataBlock_ClearAll(PyDataBlock *self)
 {
   PyDict_Clear((PyObject *) self->data);
+  if (self->shared != NULL) PySet_Clear(self->shared);
+  if (self->scan != NULL) PySet_Clear(self->scan);
 }
 
 
@@ -335,9 +922,19 @@ int PyDataBlock_ClearSection(PyDataBlock *self, PyObject *section)
 {
   int toret = 0;
   PyObject *item = NULL;
+  if (DATABLOCK_DIRTY(self, section, Py_None) != 0) goto except;
+  if (datablock_is_marked(self->shared, section) == 1) {
+    // Do not clear the dictionary shared with copies, replace it
+    item = PyDict_New();
+    if (item == NULL) goto except;
+    if (PyDict_SetItem((PyObject *) self->data, section, item) != 0) goto except;
+    if (datablock_unmark(self->shared, section) != 0) goto except;
+    goto finally;
+  }
+  if (PyErr_Occurred()) goto except;
   item = PyDataBlock_GetSection(self, section, NULL);
-  PyDict_Clear((PyObject *) item);
   if (item == NULL) goto except;
+  PyDict_Clear((PyObject *) item);
   goto finally;
 except:
   toret = -1;
@@ -362,6 +959,13 @@ static PyObject * datablock_clear(PyDataBlock *self, PyObject *args, PyObject *k
     return NULL;
 
   if (section == NULL) {
+    if (self->dirty != NULL) {
+      Py_ssize_t position = 0;
+      PyObject *item = NULL;
+      while (PyDict_Next((PyObject *) self->data, &position, &section, &item)) {
+        if (datablock_dirty(self, section, Py_None) != 0) return NULL;
+      }
+    }
     PyDataBlock_ClearAll(self);
     Py_RETURN_NONE;
   }
@@ -371,7 +975,10 @@ static PyObject * datablock_clear(PyDataBlock *self, PyObject *args, PyObject *k
 
 int PyDataBlock_DelSection(PyDataBlock *self, PyObject *section)
 {
-  return PyDict_DelItem((PyObject *) self->data, section);
+  if (DATABLOCK_DIRTY(self, section, Py_None) != 0) return -1;
+  if (PyDict_DelItem((PyObject *) self->data, section) != 0) return -1;
+  if (datablock_unmark(self->shared, section) != 0) return -1;
+  return datablock_unmark(self->scan, section);
 }
 
 
@@ -379,7 +986,10 @@ static int PyDataBlock_DelValue(PyDataBlock *self, PyObject *section, PyObject *
 {
   int toret = 0;
   PyObject *true_section = NULL, *true_name = NULL, *item = NULL;
-  if (!PyBlockMapping_ParseSectionName(self->mapping, section, name, &true_section, &true_name)) goto except;
+  if (!datablock_resolve(self, section, name, &true_section, &true_name)) goto except;
+  if (DATABLOCK_TRACE(self, true_section, true_name, DATABLOCK_TRACE_DEL) != 0) goto except;
+  if (DATABLOCK_DIRTY(self, true_section, true_name) != 0) goto except;
+  if (datablock_own_section(self, true_section) != 0) goto except;
   item = PyDataBlock_GetSection(self, true_section, NULL);
   if (item == NULL) goto except;
   toret = PyDict_DelItem(item, true_name);
@@ -392,79 +1002,246 @@ finally:
 }
 
 
-int datablock_del(PyDataBlock *self, PyObject *args)
+static int datablock_assub(PyDataBlock *self, PyObject *key, PyObject *value)
 {
+  // key is section, or (section, name); delete if value is NULL
+  PyObject *section = key, *name = NULL;
+  if (PyTuple_Check(key)) {
+    if ((PyTuple_GET_SIZE(key) < 1) || (PyTuple_GET_SIZE(key) > 2)) {
+      PyErr_SetString(PyExc_TypeError, "Key must be section or (section, name)");
+      return -1;
+    }
+    section = PyTuple_GET_ITEM(key, 0);
+    if (PyTuple_GET_SIZE(key) == 2) name = PyTuple_GET_ITEM(key, 1);
+  }
+  if (value == NULL) {
+    if (name != NULL) return PyDataBlock_DelValue(self, section, name);
+    if (DATABLOCK_TRACE(self, section, Py_None, DATABLOCK_TRACE_DEL) != 0) return -1;
+    return PyDataBlock_DelSection(self, section);
+  }
+  if (name == NULL) {
+    if (DATABLOCK_TRACE(self, section, Py_None, DATABLOCK_TRACE_SET) != 0) return -1;
+    return PyDataBlock_SetSection(self, section, value);
+  }
+  return PyDataBlock_SetValue(self, section, name, value);
+}
 
+static PyObject * datablock_set_items(PyDataBlock *self, PyObject *items)
+{
+  // items is a sequence of (key, value), key being section or (section, name); same as self[key] = value for each of them
+  PyObject *fast = NULL, *item = NULL;
+  fast = PySequence_Fast(items, "items must be a sequence of (key, value)");
+  if (fast == NULL) goto except;
+  for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(fast); i++) {
+    item = PySequence_Fast_GET_ITEM(fast, i);
+    if (!PyTuple_Check(item) || (PyTuple_GET_SIZE(item) != 2)) {
+      PyErr_SetString(PyExc_TypeError, "items must be a sequence of (key, value)");
+      goto except;
+    }
+    if (datablock_assub(self, PyTuple_GET_ITEM(item, 0), PyTuple_GET_ITEM(item, 1)) != 0) goto except;
+  }
+  Py_DECREF(fast);
+  Py_RETURN_NONE;
+except:
+  Py_XDECREF(fast);
+  return NULL;
+}
+
+static PyObject * datablock_duplicate(PyDataBlock *self, PyObject *args)
+{
+  // pairs is a sequence of (keyg, keyl), keys being section or (section, name)
+  // If keyl in self, self[keyg] = self[keyl]; if source is provided, only if keyg != keyl, else if keyl in source, self[keyg] = source[keyl]
+  PyObject *pairs = NULL, *source = NULL, *fast = NULL, *pair = NULL, *keyg = NULL, *keyl = NULL, *value = NULL;
+  int contains = 0;
+  if (!PyArg_ParseTuple(args, "O|O", &pairs, &source)) return NULL;
+  if (source == Py_None) source = NULL;
+  if ((source != NULL) && !PyDataBlock_Check(source)) {
+    PyErr_SetString(PyExc_TypeError, "source must be a DataBlock");
+    return NULL;
+  }
+  fast = PySequence_Fast(pairs, "pairs must be a sequence of (keyg, keyl)");
+  if (fast == NULL) goto except;
+  for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(fast); i++) {
+    pair = PySequence_Fast_GET_ITEM(fast, i);
+    if (!PyTuple_Check(pair) || (PyTuple_GET_SIZE(pair) != 2)) {
+      PyErr_SetString(PyExc_TypeError, "pairs must be a sequence of (keyg, keyl)");
+      goto except;
+    }
+    keyg = PyTuple_GET_ITEM(pair, 0);
+    keyl = PyTuple_GET_ITEM(pair, 1);
+    contains = 1;
+    if (source != NULL) {
+      contains = PyObject_RichCompareBool(keyg, keyl, Py_NE);
+      if (contains < 0) goto except;
+    }
+    if (contains) {
+      contains = datablock_contains(self, keyl);
+      if (contains < 0) goto except;
+      if (contains) value = PyDataBlock_GetItem(self, keyl);
+    }
+    if (!contains && (source != NULL)) {
+      contains = datablock_contains((PyDataBlock *) source, keyl);
+      if (contains < 0) goto except;
+      if (contains) value = PyDataBlock_GetItem((PyDataBlock *) source, keyl);
+    }
+    if (!contains) continue;
+    if (value == NULL) goto except;
+    if (datablock_assub(self, keyg, value) != 0) goto except;
+    Py_CLEAR(value);
+  }
+  Py_DECREF(fast);
+  Py_RETURN_NONE;
+except:
+  Py_XDECREF(value);
+  Py_XDECREF(fast);
+  return NULL;
+}
+
+static PyObject * PyDataBlock_InternKey(const char *section, const char *name)
+{
+  // Return new reference to a (section, name) tuple of interned strings, with hashes already computed
+  PyObject *toret = NULL, *py_section = NULL, *py_name = NULL;
+  py_section = PyUnicode_InternFromString(section);
+  if (py_section == NULL) goto except;
+  py_name = PyUnicode_InternFromString(name);
+  if (py_name == NULL) goto except;
+  if ((PyObject_Hash(py_section) == -1) || (PyObject_Hash(py_name) == -1)) goto except;
+  toret = PyTuple_Pack(2, py_section, py_name);
+  goto finally;
+except:
+  toret = NULL;
+finally:
+  Py_XDECREF(py_section);
+  Py_XDECREF(py_name);
+  return toret;
+}
+
+static int datablock_unpack_key(PyObject *key, PyObject **section, PyObject **name)
+{
+  // Borrowed references
+  if ((key == NULL) || !PyTuple_CheckExact(key) || (PyTuple_GET_SIZE(key) != 2)) {
+    PyErr_SetString(PyExc_TypeError, "Key must be a (section, name) tuple, see DataBlock_intern_key");
+    return 0;
+  }
+  *section = PyTuple_GET_ITEM(key, 0);
+  *name = PyTuple_GET_ITEM(key, 1);
+  return 1;
+}
+
+static int PyDataBlock_HasValueKey(PyDataBlock *self, PyObject *key)
+{
   PyObject *section = NULL, *name = NULL;
-  if (!PyArg_ParseTuple(args,"O|O", &section, &name)) return -1;
+  if (!datablock_unpack_key(key, &section, &name)) return -1;
+  return PyDataBlock_HasValue(self, section, name);
+}
 
-  if (name == NULL) return PyDataBlock_DelSection(self, section);
+static int PyDataBlock_DelValueKey(PyDataBlock *self, PyObject *key)
+{
+  PyObject *section = NULL, *name = NULL;
+  if (!datablock_unpack_key(key, &section, &name)) return -1;
   return PyDataBlock_DelValue(self, section, name);
 }
 
+static int PyDataBlock_SetValueKey(PyDataBlock *self, PyObject *key, PyObject *value)
+{
+  PyObject *section = NULL, *name = NULL;
+  if (!datablock_unpack_key(key, &section, &name)) return -1;
+  return PyDataBlock_SetValue(self, section, name, value);
+}
 
-static int datablock_assub(PyDataBlock *self, PyObject *key, PyObject *value)
+static PyObject * PyDataBlock_GetValueKey(PyDataBlock *self, PyObject *key, PyObject *default_value)
 {
-  int toret = 0;
-  MAKE_TUPLE(key);
-  if (value == NULL) {
-    toret = datablock_del(self, key);
-    goto finally;
-  }
   PyObject *section = NULL, *name = NULL;
-  if (!PyArg_ParseTuple(key,"O|O", &section, &name)) goto except;
-  if (name == NULL) {
-    toret = PyDataBlock_SetSection(self, section, value);
-    goto finally;
+  if (!datablock_unpack_key(key, &section, &name)) return NULL;
+  return PyDataBlock_GetValue(self, section, name, default_value);
+}
+
+static Py_ssize_t array_conversions = 0; // number of implicit array conversion copies, see PyDataBlock_ArrayConversion
+
+static int PyDataBlock_ArrayConversion(PyObject *key, const char *type)
+{
+  // Count an implicit copy of the array at (section, name) key, to convert it to a C-contiguous array of type, and warn about it
+  // Return -1 if the warning is turned into an exception
+  array_conversions++;
+  return PyErr_WarnFormat(PyExc_RuntimeWarning, 1, "Array [%S] %S copied to convert it to a C-contiguous %s array; "
+                          "declare it with DataBlock_declare_%s_array to avoid copies",
+                          PyTuple_GET_ITEM(key, 0), PyTuple_GET_ITEM(key, 1), type, type);
+}
+
+static PyObject * block_array_conversions(PyObject *module, PyObject *args, PyObject *kwds)
+{
+  static char *kwlist[] = {"reset", NULL};
+  int reset = 0;
+  Py_ssize_t toret = array_conversions;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|p", kwlist, &reset)) return NULL;
+  if (reset) array_conversions = 0;
+  return PyLong_FromSsize_t(toret);
+}
+
+static PyObject * datablock_default_nocopy(PyDataBlock *self, PyObject *nocopy)
+{
+  // Return new reference to nocopy, or if NULL or None, to the list of common sections in self
+  PyObject *toret = NULL, *sections = NULL, *section;
+  Py_ssize_t isection;
+  if ((nocopy != NULL) && (nocopy != Py_None)) {
+    Py_INCREF(nocopy);
+    return nocopy;
+  }
+  sections = datablock_common_sections();
+  if (sections == NULL) goto except;
+  toret = PyList_New(0);
+  if (toret == NULL) goto except;
+  for (isection = 0; isection < PyTuple_GET_SIZE(sections); isection++) {
+    section = PyTuple_GET_ITEM(sections, isection);
+    if ((PyDataBlock_HasSection(self, section) == 1) && (PyList_Append(toret, section) != 0)) goto except;
   }
-  toret = PyDataBlock_SetValue(self, section, name, value);
   goto finally;
 except:
-  toret = -1;
+  Py_CLEAR(toret);
 finally:
-  Py_XDECREF(key);
   return toret;
 }
 
 int PyDataBlock_Update(PyDataBlock *self, PyObject *other, PyObject *nocopy)
 {
-  int toret = 0;
+  // Sections of DataBlock other not in nocopy are shared until written to (copy-on-write)
+  int toret = 0, contains = 0;
   Py_ssize_t position = 0;
-  PyObject *section, *item;
+  PyObject *data = other, *section, *item;
+  PyDataBlock *other_block = NULL;
   Py_INCREF(other);
 
   if (PyDataBlock_Check(other)) {
-    //if (PyDict_Update((PyObject *) self->data,(PyObject *) ((PyDataBlock *) other)->data) == 0) goto finally;
-    //goto except;
-    PyObject * tmp = other;
-    other = (PyObject *) ((PyDataBlock *) tmp)->data;
-    Py_INCREF(other);
-    Py_DECREF(tmp);
+    other_block = (PyDataBlock *) other;
+    data = (PyObject *) other_block->data;
   }
 
-  if (!PyDict_Check(other)) {
+  if (!PyDict_Check(data)) {
     PyErr_SetString(PyExc_TypeError,"Please provide a dictionary.");
     goto except;
   }
-
-  if (nocopy == NULL) {
-    while (PyDict_Next(other, &position, &section, &item)) {
-      //printf("Ref count 1 %d %d\n",Py_REFCNT(section),Py_REFCNT(item));
-      if (PyDataBlock_SetSection(self, section, item) != 0) goto except;
-      //printf("Ref count 2 %d %d\n",Py_REFCNT(section),Py_REFCNT(item));
-    }
-    goto finally;
-  }
-  if ((!PyTuple_Check(nocopy)) & (!PyList_Check(nocopy))) {
+  if ((nocopy != NULL) && (!PyTuple_Check(nocopy)) & (!PyList_Check(nocopy))) {
     PyErr_SetString(PyExc_TypeError,"Argument 'nocopy' should be a tuple or list.");
     goto except;
   }
-  while (PyDict_Next(other, &position, &section, &item)) {
-    int contains = PySequence_Contains(nocopy, section);
-    //printf("Contains %d\n",contains);
-    if (contains < 0) goto except;
-    else if (contains) {
+  while (PyDict_Next(data, &position, &section, &item)) {
+    if (nocopy != NULL) {
+      contains = PySequence_Contains(nocopy, section);
+      if (contains < 0) goto except;
+    }
+    if (contains) {
+      // The dictionary is shared on purpose: no copy on write, in self and other
+      if (other_block != NULL) {
+        if (datablock_own_section(other_block, section) != 0) goto except;
+        item = PyDict_GetItem(data, section);
+      }
+      if (DATABLOCK_DIRTY(self, section, Py_None) != 0) goto except;
       if (PyDict_SetItem((PyObject *) self->data, section, item) != 0) goto except;
+      if (datablock_unmark(self->shared, section) != 0) goto except;
+    }
+    else if ((other_block != NULL) && (PyDataBlock_HasSection(self, section) != 1)) {
+      if (DATABLOCK_DIRTY(self, section, Py_None) != 0) goto except;
+      if (datablock_share_section(self, other_block, section, item) != 0) goto except;
     }
     else if (PyDataBlock_SetSection(self, section, item) != 0) goto except;
   }
@@ -480,11 +1257,28 @@ static PyObject * datablock_update(PyDataBlock *self, PyObject *args, PyObject *
 {
   static char *kwlist[] = {"other", "nocopy", NULL};
   PyObject *other = NULL, *nocopy = NULL;
+  int toret = 0;
   if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist, &other, &nocopy)) return NULL;
-  if (PyDataBlock_Update(self, other, nocopy) == 0) Py_RETURN_NONE;
+  nocopy = datablock_default_nocopy(self, nocopy);
+  if (nocopy == NULL) return NULL;
+  toret = PyDataBlock_Update(self, other, nocopy);
+  Py_DECREF(nocopy);
+  if (toret == 0) Py_RETURN_NONE;
   return NULL;
 }
 
+static PyObject * datablock_setdefault(PyDataBlock *self, PyObject *args)
+{
+  // Set value only if (section, name) is not in self
+  int contains = 0;
+  PyObject *section = NULL, *name = NULL, *value = NULL;
+  if (!PyArg_ParseTuple(args, "OOO", &section, &name, &value)) return NULL;
+  contains = PyDataBlock_HasValue(self, section, name);
+  if (contains < 0) return NULL;
+  if (!contains && (PyDataBlock_SetValue(self, section, name, value) != 0)) return NULL;
+  Py_RETURN_NONE;
+}
+
 static PyObject * datablock_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
   PyDataBlock *self = (PyDataBlock *) type->tp_alloc(type, 0);
@@ -494,6 +1288,13 @@ static PyObject * datablock_new(PyTypeObject *type, PyObject *args, PyObject *kw
   if (self->data == NULL) goto except;
   self->mapping = (PyBlockMapping *) PyBlockMapping_New();
   if (self->mapping == NULL) goto except;
+  self->mapping_cache = NULL;
+  self->mapping_cache_version = 0;
+  self->shared = NULL;
+  self->scan = NULL;
+  self->exposed = NULL;
+  self->trace = NULL;
+  self->dirty = NULL;
   goto finally;
 except:
   Py_CLEAR(self->data);
@@ -507,9 +1308,18 @@ finally:
 PyDataBlock * PyDataBlock_New(void)
 {
   PyDataBlock *toret = PyObject_GC_New(PyDataBlock, &PyDataBlockType);
+  if (toret == NULL) return NULL;
+  toret->mapping_cache = NULL;
+  toret->mapping_cache_version = 0;
+  toret->shared = NULL;
+  toret->scan = NULL;
+  toret->exposed = NULL;
+  toret->trace = NULL;
+  toret->dirty = NULL;
+  toret->mapping = NULL;
   toret->data = (PyDictObject *) PyDict_New();
   if (toret->data == NULL) goto except;
-  toret->mapping = (PyBlockMapping *) PyDict_New();
+  toret->mapping = (PyBlockMapping *) PyBlockMapping_New();
   if (toret->mapping == NULL) goto except;
   //if (PyObject_GC_IsTracked(self))
   PyObject_GC_Track(toret);
@@ -517,7 +1327,7 @@ PyDataBlock * PyDataBlock_New(void)
 except:
   Py_CLEAR(toret->data);
   Py_CLEAR(toret->mapping);
-  Py_XDECREF(toret);
+  PyObject_GC_Del(toret);
   toret = NULL;
 finally:
   return toret;
@@ -525,16 +1335,20 @@ finally:
 
 PyDataBlock * PyDataBlock_Copy(PyDataBlock *self, PyObject *nocopy)
 {
-  PyDataBlock *toret = NULL;
-
-  toret = PyDataBlock_New();
+  // Return new DataBlock of the same type as self, sharing its mapping, and its sections until written to (copy-on-write)
+  PyDataBlock *toret = (PyDataBlock *) Py_TYPE(self)->tp_alloc(Py_TYPE(self), 0);
   if (toret == NULL) goto except;
 
-  if (PyDataBlock_Update(toret, (PyObject *) self, nocopy) != 0) goto except;
-
+  toret->data = (PyDictObject *) PyDict_New();
+  if (toret->data == NULL) goto except;
   Py_INCREF(self->mapping);
-  Py_CLEAR(toret->mapping);
   toret->mapping = self->mapping;
+  // Same mapping, hence same resolved (section, name)
+  Py_XINCREF(self->mapping_cache);
+  toret->mapping_cache = self->mapping_cache;
+  toret->mapping_cache_version = self->mapping_cache_version;
+
+  if (PyDataBlock_Update(toret, (PyObject *) self, nocopy) != 0) goto except;
   goto finally;
 except:
   Py_XDECREF(toret);
@@ -547,8 +1361,13 @@ PyDataBlock * datablock_copy(PyDataBlock *self, PyObject *args, PyObject *kwds)
 {
   PyObject *nocopy = NULL;
   static char *kwlist[] = {"nocopy", NULL};
+  PyDataBlock *toret = NULL;
   if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O", kwlist, &nocopy)) return NULL;
-  return PyDataBlock_Copy(self, nocopy);
+  nocopy = datablock_default_nocopy(self, nocopy);
+  if (nocopy == NULL) return NULL;
+  toret = PyDataBlock_Copy(self, nocopy);
+  Py_DECREF(nocopy);
+  return toret;
 }
 
 
@@ -572,6 +1391,7 @@ int PyDataBlock_SetMapping(PyDataBlock *self, PyObject *mapping)
   }
   Py_CLEAR(self->mapping);
   self->mapping = mapping_;
+  Py_CLEAR(self->mapping_cache);
   goto finally;
 except:
   Py_XDECREF(mapping_);
@@ -587,7 +1407,59 @@ static PyObject * datablock_set_mapping(PyDataBlock *self, PyObject *mapping)
 }
 
 
+static PyObject * datablock_set_trace(PyDataBlock *self, PyObject *trace)
+{
+  // Record accesses into dictionary trace, stop if None
+  if ((trace != Py_None) && !PyDict_Check(trace)) {
+    PyErr_SetString(PyExc_TypeError, "Trace must be a dictionary or None");
+    return NULL;
+  }
+  Py_CLEAR(self->trace);
+  if (trace != Py_None) {
+    Py_INCREF(trace);
+    self->trace = trace;
+  }
+  Py_RETURN_NONE;
+}
+
+
+static PyObject * datablock_trace_getter(PyDataBlock *self, void *closure) {
+  if (self->trace == NULL) Py_RETURN_NONE;
+  Py_INCREF(self->trace);
+  return self->trace;
+}
+
+
+static PyObject * datablock_set_dirty(PyDataBlock *self, PyObject *dirty)
+{
+  // Record modified entries into dictionary dirty, stop if None
+  if ((dirty != Py_None) && !PyDict_Check(dirty)) {
+    PyErr_SetString(PyExc_TypeError, "Dirty must be a dictionary or None");
+    return NULL;
+  }
+  Py_CLEAR(self->dirty);
+  if (dirty != Py_None) {
+    Py_INCREF(dirty);
+    self->dirty = dirty;
+  }
+  Py_RETURN_NONE;
+}
+
+
+static PyObject * datablock_dirty_getter(PyDataBlock *self, void *closure) {
+  if (self->dirty == NULL) Py_RETURN_NONE;
+  Py_INCREF(self->dirty);
+  return self->dirty;
+}
+
+
 static PyObject * datablock_data_getter(PyDataBlock *self, void *closure) {
+  // Section dictionaries may be modified by the caller, now or later: never share them with copies again
+  // Any section may be read or written through the data dictionary: section None marks all accesses as unknown in the trace
+  if (datablock_trace_sections(self, NULL, DATABLOCK_TRACE_GET | DATABLOCK_TRACE_SET) != 0) return NULL;
+  if (DATABLOCK_TRACE(self, Py_None, Py_None, DATABLOCK_TRACE_GET | DATABLOCK_TRACE_SET) != 0) return NULL;
+  if (datablock_own_sections(self) != 0) return NULL;
+  if (datablock_mark(&self->exposed, Py_None) != 0) return NULL;
   PyObject * toret = (PyObject *) self->data;
   Py_XINCREF(toret);
   return toret;
@@ -621,10 +1493,10 @@ PyObject * PyDataBlock_Str(PyDataBlock *self)
 static int datablock_init(PyDataBlock *self, PyObject *args, PyObject *kwds)
 {
   int toret = 0;
-  static char *kwlist[] = {"data", "mapping", NULL};
-  PyObject *data = NULL, *mapping = NULL;
+  static char *kwlist[] = {"data", "mapping", "add_sections", NULL};
+  PyObject *data = NULL, *mapping = NULL, *add_sections = NULL, *iter_sections = NULL, *section = NULL, *item = NULL;
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OO", kwlist, &data, &mapping)) goto except;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OOO", kwlist, &data, &mapping, &add_sections)) goto except;
 
   if ((data != NULL) & (data != Py_None)) {
     if (PyDataBlock_Check(data)) {
@@ -636,16 +1508,42 @@ static int datablock_init(PyDataBlock *self, PyObject *args, PyObject *kwds)
       Py_INCREF(mapping_);
       Py_CLEAR(self->mapping);
       self->mapping = mapping_;
+      Py_CLEAR(self->mapping_cache);
+      // Same data dictionary, hence same copy-on-write state
+      if (datablock_alias_marks(&self->shared, &((PyDataBlock *) data)->shared) != 0) goto except;
+      if (datablock_alias_marks(&self->scan, &((PyDataBlock *) data)->scan) != 0) goto except;
+      if (datablock_alias_marks(&self->exposed, &((PyDataBlock *) data)->exposed) != 0) goto except;
     }
     else if (PyDataBlock_Update(self, data, NULL) != 0) goto except;
   }
   if ((mapping != NULL) & (mapping != Py_None)) {
     if (PyDataBlock_SetMapping(self, mapping) != 0) goto except;
   }
+  if ((add_sections == NULL) || (add_sections == Py_None)) {
+    add_sections = datablock_common_sections();
+    if (add_sections == NULL) goto except;
+  }
+  iter_sections = PyObject_GetIter(add_sections);
+  if (iter_sections == NULL) goto except;
+  while ((section = PyIter_Next(iter_sections))) {
+    toret = PyDataBlock_HasSection(self, section);
+    if (toret == 0) {
+      item = PyDict_New();
+      if (item == NULL) goto except;
+      toret = PyDataBlock_SetSection(self, section, item);
+      Py_CLEAR(item);
+    }
+    Py_CLEAR(section);
+    if (toret < 0) goto except;
+  }
+  if (PyErr_Occurred()) goto except;
+  toret = 0;
   goto finally;
 except:
   toret = -1;
 finally:
+  Py_XDECREF(section);
+  Py_XDECREF(iter_sections);
   return toret;
 }
 
@@ -655,6 +1553,12 @@ static int datablock_traverse(PyDataBlock *self, visitproc visit, void *arg)
 {
   Py_VISIT(self->data);
   Py_VISIT(self->mapping);
+  Py_VISIT(self->mapping_cache);
+  Py_VISIT(self->shared);
+  Py_VISIT(self->scan);
+  Py_VISIT(self->exposed);
+  Py_VISIT(self->trace);
+  Py_VISIT(self->dirty);
   return 0;
 }
 
@@ -662,6 +1566,12 @@ static int datablock_tp_clear(PyDataBlock *self)
 {
   Py_CLEAR(self->data);
   Py_CLEAR(self->mapping);
+  Py_CLEAR(self->mapping_cache);
+  Py_CLEAR(self->shared);
+  Py_CLEAR(self->scan);
+  Py_CLEAR(self->exposed);
+  Py_CLEAR(self->trace);
+  Py_CLEAR(self->dirty);
   return 0;
 }
 
@@ -683,14 +1593,20 @@ static PyMemberDef PyDataBlock_members[] = {
 
 static PyMethodDef PyDataBlock_methods[] = {
   {"sections", (PyCFunction) PyDataBlock_Sections, METH_NOARGS, "Return sections"},
-  {"keys", (PyCFunction) datablock_keys, METH_VARARGS | METH_KEYWORDS, "Return keys"},
-  {"items", (PyCFunction) datablock_items, METH_VARARGS | METH_KEYWORDS, "Return items"},
-  {"get", (PyCFunction) datablock_get, METH_VARARGS | METH_KEYWORDS, "Return item"},
-  {"has", (PyCFunction) datablock_has, METH_VARARGS | METH_KEYWORDS, "Has item"},
-  {"set", (PyCFunction) datablock_set, METH_VARARGS, "Set item"},
+  {"keys", (PyCFunction) datablock_keys, METH_VARARGS | METH_KEYWORDS, "Return view on keys, optionally restricted to section"},
+  {"items", (PyCFunction) datablock_items, METH_VARARGS | METH_KEYWORDS, "Return view on items, optionally restricted to section"},
+  {"values", (PyCFunction) datablock_values, METH_VARARGS | METH_KEYWORDS, "Return view on values, optionally restricted to section"},
+  {"get", (PyCFunction)(void(*)(void)) datablock_get, METH_FASTCALL | METH_KEYWORDS, "Return item"},
+  {"has", (PyCFunction)(void(*)(void)) datablock_has, METH_FASTCALL | METH_KEYWORDS, "Has item"},
+  {"set", (PyCFunction)(void(*)(void)) datablock_set, METH_FASTCALL, "Set item"},
   {"set_mapping", (PyCFunction) datablock_set_mapping, METH_O, "Set item"},
-  {"update", (PyCFunction) datablock_update, METH_VARARGS | METH_KEYWORDS, "Update DataBlock"},
-  {"copy", (PyCFunction) datablock_copy, METH_VARARGS | METH_KEYWORDS, "Copy DataBlock"},
+  {"set_trace", (PyCFunction) datablock_set_trace, METH_O, "Record accesses into dictionary {section: {name: flags}}, stop if None"},
+  {"set_dirty", (PyCFunction) datablock_set_dirty, METH_O, "Record modified entries into dictionary {section: set of names}, stop if None"},
+  {"setdefault", (PyCFunction) datablock_setdefault, METH_VARARGS, "Set item if not in DataBlock"},
+  {"set_items", (PyCFunction) datablock_set_items, METH_O, "Set items from sequence of (key, value)"},
+  {"duplicate", (PyCFunction) datablock_duplicate, METH_VARARGS, "Duplicate items from sequence of (keyg, keyl), looking up keyl in DataBlock, else in source"},
+  {"update", (PyCFunction) datablock_update, METH_VARARGS | METH_KEYWORDS, "Update DataBlock, without copying sections in nocopy (default: common sections)"},
+  {"copy", (PyCFunction) datablock_copy, METH_VARARGS | METH_KEYWORDS, "Copy DataBlock, without copying sections in nocopy (default: common sections)"},
   {"clear", (PyCFunction) datablock_clear, METH_VARARGS | METH_KEYWORDS, "Clear DataBlock"},
   {"__getitem__", (PyCFunction) PyDataBlock_GetItem, METH_O | METH_COEXIST, "x.__getitem__(y) <==> x[y]"},
   {NULL}  /* Sentinel */
@@ -711,7 +1627,7 @@ static PySequenceMethods PyDataBlock_as_sequence = {
   0,                          /* sq_slice */
   0,                          /* sq_ass_item */
   0,                          /* sq_ass_slice */
-  datablock_contains,         /* sq_contains */
+  (objobjproc)datablock_contains, /* sq_contains */
   0,                          /* sq_inplace_concat */
   0,                          /* sq_inplace_repeat */
 };
@@ -720,6 +1636,8 @@ static PySequenceMethods PyDataBlock_as_sequence = {
 static PyGetSetDef PyDataBlock_properties[] = {
   {"data", (getter) datablock_data_getter, NULL, "Data dictionary", NULL},
   {"mapping", (getter) datablock_mapping_getter, NULL, "BlockMapping instance", NULL},
+  {"trace", (getter) datablock_trace_getter, NULL, "Dictionary where accesses are recorded, None if not tracing", NULL},
+  {"dirty", (getter) datablock_dirty_getter, NULL, "Dictionary where modified entries are recorded, None if not tracking", NULL},
   {NULL}
 };
 
@@ -741,6 +1659,7 @@ PyTypeObject PyDataBlockType = {
   .tp_members = PyDataBlock_members,
   .tp_methods = PyDataBlock_methods,
   .tp_getset = PyDataBlock_properties,
+  .tp_iter = (getiterfunc) datablock_iter,
   .tp_repr = (reprfunc) PyDataBlock_Repr,
   .tp_str = (reprfunc) PyDataBlock_Str
 };
@@ -765,12 +1684,17 @@ static PyTypeObject PyDataBlockType = {
 };
 */
 
+static PyMethodDef block_methods[] = {
+  {"array_conversions", (PyCFunction)(void(*)(void)) block_array_conversions, METH_VARARGS | METH_KEYWORDS, "Return number of implicit array conversion copies by compiled modules, reset to 0 if reset"},
+  {NULL}  /* Sentinel */
+};
+
 static PyModuleDef blockmodule = {
   PyModuleDef_HEAD_INIT,
   .m_name = "block",
   .m_doc = "Block module that creates DataBlock.",
   .m_size = -1,
-  .m_methods = NULL
+  .m_methods = block_methods
 };
 
 PyMODINIT_FUNC
@@ -779,6 +1703,10 @@ PyInit_block(void)
   PyObject *m;
   if (PyType_Ready(&PyDataBlockType) < 0) return NULL;
   if (PyType_Ready(&PyBlockMappingType) < 0) return NULL;
+  if (PyType_Ready(&PyDataBlockIteratorType) < 0) return NULL;
+  if (PyType_Ready(&PyDataBlockKeysViewType) < 0) return NULL;
+  if (PyType_Ready(&PyDataBlockItemsViewType) < 0) return NULL;
+  if (PyType_Ready(&PyDataBlockValuesViewType) < 0) return NULL;
 
   m = PyModule_Create(&blockmodule);
   if (m == NULL) return NULL;
@@ -798,6 +1726,18 @@ PyInit_block(void)
     return NULL;
   }
 
+  if ((PyModule_AddIntConstant(m, "TRACE_GET", DATABLOCK_TRACE_GET) < 0) || (PyModule_AddIntConstant(m, "TRACE_HAS", DATABLOCK_TRACE_HAS) < 0)
+      || (PyModule_AddIntConstant(m, "TRACE_SET", DATABLOCK_TRACE_SET) < 0) || (PyModule_AddIntConstant(m, "TRACE_DEL", DATABLOCK_TRACE_DEL) < 0)) {
+    Py_DECREF(m);
+    return NULL;
+  }
+
+  copy_hook_name = PyUnicode_InternFromString("_copy_if_datablock_copy");
+  if (copy_hook_name == NULL) {
+    Py_DECREF(m);
+    return NULL;
+  }
+
   static void *PyDataBlock_API[PyDataBlock_API_pointers];
 
   /* Initialize the C API pointer array */
@@ -805,6 +1745,12 @@ PyInit_block(void)
   PyDataBlock_API[PyDataBlock_DelValue_NUM] = (void *) PyDataBlock_DelValue;
   PyDataBlock_API[PyDataBlock_SetValue_NUM] = (void *) PyDataBlock_SetValue;
   PyDataBlock_API[PyDataBlock_GetValue_NUM] = (void *) PyDataBlock_GetValue;
+  PyDataBlock_API[PyDataBlock_InternKey_NUM] = (void *) PyDataBlock_InternKey;
+  PyDataBlock_API[PyDataBlock_HasValueKey_NUM] = (void *) PyDataBlock_HasValueKey;
+  PyDataBlock_API[PyDataBlock_DelValueKey_NUM] = (void *) PyDataBlock_DelValueKey;
+  PyDataBlock_API[PyDataBlock_SetValueKey_NUM] = (void *) PyDataBlock_SetValueKey;
+  PyDataBlock_API[PyDataBlock_GetValueKey_NUM] = (void *) PyDataBlock_GetValueKey;
+  PyDataBlock_API[PyDataBlock_ArrayConversion_NUM] = (void *) PyDataBlock_ArrayConversion;
 
   /* Create a Capsule containing the API pointer array's address */
   PyObject * c_api_object = PyCapsule_New((void *)PyDataBlock_API, "pypescript.lib.block._C_API", NULL);
@@ -12,8 +12,28 @@ typedef struct {
   PyObject_HEAD
   PyDictObject *data;
   PyBlockMapping *mapping;
+  // Cache of resolved {section: {name: (true_section, true_name)}} for mapping, valid for mapping_cache_version
+  PyDictObject *mapping_cache;
+  unsigned long long mapping_cache_version;
+  // Sets of sections whose dictionary may be shared with copies (copy-on-write), or may hold _copy_if_datablock_copy values
+  // NULL if empty
+  PyObject *shared;
+  PyObject *scan;
+  // Set holding None once the data dictionary has been handed out (data attribute), such that any section may be modified
+  // outside self: copies then duplicate sections right away; shared by DataBlock instances sharing the same data dictionary, NULL if empty
+  PyObject *exposed;
+  // Dictionary {true_section: {true_name: flags}} where accesses are recorded (see DATABLOCK_TRACE_*), NULL if not tracing
+  PyObject *trace;
+  // Dictionary {true_section: set of true_name} of entries set or deleted (name is None for whole sections), NULL if not tracking
+  PyObject *dirty;
 } PyDataBlock;
 
+// Access flags recorded in PyDataBlock.trace; name is None for whole-section accesses
+#define DATABLOCK_TRACE_GET 1
+#define DATABLOCK_TRACE_HAS 2
+#define DATABLOCK_TRACE_SET 4
+#define DATABLOCK_TRACE_DEL 8
+
 extern PyTypeObject PyDataBlockType;
 
 #define PyDataBlock_Check(op) PyObject_TypeCheck(op, &PyDataBlockType)
@@ -39,8 +59,38 @@ extern PyTypeObject PyDataBlockType;
 #define PyDataBlock_GetValue_RETURN PyObject *
 #define PyDataBlock_GetValue_PROTO (PyDataBlock *self, PyObject *section, PyObject *name, PyObject *default_value)
 
+//PyObject * PyDataBlock_InternKey(const char *section, const char *name);
+#define PyDataBlock_InternKey_NUM 4
+#define PyDataBlock_InternKey_RETURN PyObject *
+#define PyDataBlock_InternKey_PROTO (const char *section, const char *name)
+
+//int PyDataBlock_HasValueKey(PyDataBlock *self, PyObject *key);
+#define PyDataBlock_HasValueKey_NUM 5
+#define PyDataBlock_HasValueKey_RETURN int
+#define PyDataBlock_HasValueKey_PROTO (PyDataBlock *self, PyObject *key)
+
+//int PyDataBlock_DelValueKey(PyDataBlock *self, PyObject *key);
+#define PyDataBlock_DelValueKey_NUM 6
+#define PyDataBlock_DelValueKey_RETURN int
+#define PyDataBlock_DelValueKey_PROTO (PyDataBlock *self, PyObject *key)
+
+//int PyDataBlock_SetValueKey(PyDataBlock *self, PyObject *key, PyObject *value);
+#define PyDataBlock_SetValueKey_NUM 7
+#define PyDataBlock_SetValueKey_RETURN int
+#define PyDataBlock_SetValueKey_PROTO (PyDataBlock *self, PyObject *key, PyObject *value)
+
+//PyObject * PyDataBlock_GetValueKey(PyDataBlock *self, PyObject *key, PyObject *default_value);
+#define PyDataBlock_GetValueKey_NUM 8
+#define PyDataBlock_GetValueKey_RETURN PyObject *
+#define PyDataBlock_GetValueKey_PROTO (PyDataBlock *self, PyObject *key, PyObject *default_value)
+
+//int PyDataBlock_ArrayConversion(PyObject *key, const char *type);
+#define PyDataBlock_ArrayConversion_NUM 9
+#define PyDataBlock_ArrayConversion_RETURN int
+#define PyDataBlock_ArrayConversion_PROTO (PyObject *key, const char *type)
+
 /* Total number of C API pointers */
-#define PyDataBlock_API_pointers 4
+#define PyDataBlock_API_pointers 10
 
 
 #ifdef DATABLOCK_MODULE
@@ -50,6 +100,12 @@ static PyDataBlock_HasValue_RETURN PyDataBlock_HasValue PyDataBlock_HasValue_PRO
 static PyDataBlock_DelValue_RETURN PyDataBlock_DelValue PyDataBlock_DelValue_PROTO;
 static PyDataBlock_SetValue_RETURN PyDataBlock_SetValue PyDataBlock_SetValue_PROTO;
 static PyDataBlock_GetValue_RETURN PyDataBlock_GetValue PyDataBlock_GetValue_PROTO;
+static PyDataBlock_InternKey_RETURN PyDataBlock_InternKey PyDataBlock_InternKey_PROTO;
+static PyDataBlock_HasValueKey_RETURN PyDataBlock_HasValueKey PyDataBlock_HasValueKey_PROTO;
+static PyDataBlock_DelValueKey_RETURN PyDataBlock_DelValueKey PyDataBlock_DelValueKey_PROTO;
+static PyDataBlock_SetValueKey_RETURN PyDataBlock_SetValueKey PyDataBlock_SetValueKey_PROTO;
+static PyDataBlock_GetValueKey_RETURN PyDataBlock_GetValueKey PyDataBlock_GetValueKey_PROTO;
+static PyDataBlock_ArrayConversion_RETURN PyDataBlock_ArrayConversion PyDataBlock_ArrayConversion_PROTO;
 
 #else
 // This section is used in modules that use blockmodule's API
@@ -68,6 +124,24 @@ static void **PyDataBlock_API;
 #define PyDataBlock_GetValue \
  (*(PyDataBlock_GetValue_RETURN (*)PyDataBlock_GetValue_PROTO) PyDataBlock_API[PyDataBlock_GetValue_NUM])
 
+#define PyDataBlock_InternKey \
+ (*(PyDataBlock_InternKey_RETURN (*)PyDataBlock_InternKey_PROTO) PyDataBlock_API[PyDataBlock_InternKey_NUM])
+
+#define PyDataBlock_HasValueKey \
+ (*(PyDataBlock_HasValueKey_RETURN (*)PyDataBlock_HasValueKey_PROTO) PyDataBlock_API[PyDataBlock_HasValueKey_NUM])
+
+#define PyDataBlock_DelValueKey \
+ (*(PyDataBlock_DelValueKey_RETURN (*)PyDataBlock_DelValueKey_PROTO) PyDataBlock_API[PyDataBlock_DelValueKey_NUM])
+
+#define PyDataBlock_SetValueKey \
+ (*(PyDataBlock_SetValueKey_RETURN (*)PyDataBlock_SetValueKey_PROTO) PyDataBlock_API[PyDataBlock_SetValueKey_NUM])
+
+#define PyDataBlock_GetValueKey \
+ (*(PyDataBlock_GetValueKey_RETURN (*)PyDataBlock_GetValueKey_PROTO) PyDataBlock_API[PyDataBlock_GetValueKey_NUM])
+
+#define PyDataBlock_ArrayConversion \
+ (*(PyDataBlock_ArrayConversion_RETURN (*)PyDataBlock_ArrayConversion_PROTO) PyDataBlock_API[PyDataBlock_ArrayConversion_NUM])
+
 // Return -1 on error, 0 on success.
 // PyCapsule_Import will set an exception if there's an error.
 
@@ -42,25 +42,25 @@ class ConfigBlock(DataBlock):
             Used when ``data`` is string, or ``string`` is not ``None``.
         """
         if isinstance(data,ConfigBlock):
-            block.DataBlock.__init__(self,data=data)
+            block.DataBlock.__init__(self,data=data,add_sections=[])
             self.raw = data.raw
             return
 
-        if isinstance(data,str) and data.endswith(syntax.block_save_extension):
+        if isinstance(data,str) and data.endswith((syntax.block_save_extension,syntax.block_file_extension)):
             new = self.load(data)
-            block.DataBlock.__init__(self,data=new)
+            block.DataBlock.__init__(self,data=new,add_sections=[])
             self.raw = new.data
             return
 
         decoder = Decoder(data=data,string=string,parser=parser)
         # filter those entries which match the (section,name) format
         data = {key:value for key,value in decoder.items() if isinstance(value,dict)}
-        block.DataBlock.__init__(self,data=data,mapping=BlockMapping(decoder.mapping))
+        block.DataBlock.__init__(self,data=data,mapping=BlockMapping(decoder.mapping),add_sections=[])
         self.raw = decoder.raw
 
     def __copy__(self):
         new = self.__class__.__new__(self.__class__)
-        block.DataBlock.__init__(self,data=self.data.copy(),mapping=self.mapping)
+        block.DataBlock.__init__(self,data=self.data.copy(),mapping=self.mapping,add_sections=[])
         new.raw = self.raw
         return new
 
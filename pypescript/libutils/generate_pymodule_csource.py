@@ -15,7 +15,7 @@ for fun in ['setup','execute','cleanup']:
       PyObject *name = NULL, *config_block = NULL, *data_block = NULL;
       if (!PyArg_ParseTuple(args, "OOO", &name, &config_block, &data_block)) goto except;
       const char * name_str = PyUnicode_AsUTF8(name);
-      toret = ##__fun##(name_str, (DataBlock *) config_block, (DataBlock *) data_block);
+      ##__call##
       //if (toret != 0) _PyErr_FormatFromCause(PyExc_RuntimeError,"Exception (signal %d) in function ##__fun## of ##__module_name## [%S].", toret, name);
       if ((toret != 0) && (!PyErr_Occurred()))
         PyErr_Format(PyExc_RuntimeError,"Exception (signal %d) in function ##__fun## of ##__module_name## [%S].", toret, name);
@@ -51,7 +51,15 @@ PyInit_##__module_name##(void)
 }
 """
 
-def write_csource(filename, module_name, doc=''):
+call_template = "toret = ##__fun##(name_str, (DataBlock *) config_block, (DataBlock *) data_block);"
+
+# the module calls DataBlock_acquire/DataBlock_release around DataBlock accesses
+call_release_gil_template = """Py_BEGIN_ALLOW_THREADS
+      """ + call_template + """
+      Py_END_ALLOW_THREADS"""
+
+
+def write_csource(filename, module_name, doc='', release_gil=False):
     """
     Write C source file to turn C/C++/Fortran code into a Python extension.
 
@@ -65,8 +73,16 @@ def write_csource(filename, module_name, doc=''):
 
     doc : string, default=''
         Short module documentation.
+
+    release_gil : bool, default=False
+        Whether to release the Python GIL while calling ``setup``, ``execute`` and ``cleanup``.
+        These should then call ``DataBlock_acquire`` and ``DataBlock_release`` around :class:`~pypescript.block.DataBlock` accesses.
     """
-    content = template.replace('##__module_name##',module_name).replace('##__doc##',doc)
+    call = call_release_gil_template if release_gil else call_template
+    content = template
+    for fun in ['setup','execute','cleanup']:
+        content = content.replace('##__call##',call.replace('##__fun##',fun),1)
+    content = content.replace('##__module_name##',module_name).replace('##__doc##',doc)
     utils.mkdir(filename)
     with open(filename,'w') as file:
         file.write(content)
@@ -55,6 +55,11 @@ class Extension(_Extension):
     description_file : string, default None
         Module description file name.
 
+    release_gil : bool, default=False
+        Whether to release the Python GIL while calling the module ``setup``, ``execute`` and ``cleanup``,
+        which allows them to run concurrently on threads.
+        These should then call ``DataBlock_acquire`` and ``DataBlock_release`` around :class:`~pypescript.block.DataBlock` accesses.
+
     args : tuple
         Other arguments for :class:`numpy.distutils.extension.Extension`.
 
@@ -66,11 +71,12 @@ class Extension(_Extension):
     In :mod:`numpy.distutils`, **f2py** is called if Fortran source files are provided.
     Here, **f2py** is called if Fortran source files are provided AND a (possibly empty) list ``f2py_options`` is provided.
     """
-    def __init__(self, *args, module_dir='.', doc=None, description_file=None, **kwargs):
+    def __init__(self, *args, module_dir='.', doc=None, description_file=None, release_gil=False, **kwargs):
         super(Extension,self).__init__(*args,**kwargs)
         self.module_dir = module_dir
         self.doc = doc
         self.description_file = description_file
+        self.release_gil = release_gil
         self.is_pypemodule = description_file is not None
         if self.is_pypemodule:
             if self.has_fortran_sources():
@@ -97,6 +103,7 @@ class Extension(_Extension):
         new = cls.__new__(cls)
         new.__dict__.update(ext)
         new.is_pypemodule = False
+        new.release_gil = False
         new.use_f2py = new.has_f2py_sources()
 
 
@@ -172,7 +179,7 @@ class build_src(_build_src):
             target_dir = appendpath(self.build_src, extension.module_dir)
         target_file = os.path.join(target_dir, ext_name + 'module.c')
         if newer_group([extension.description_file], target_file):
-            write_csource(filename=target_file,module_name=ext_name,doc=extension.doc)
+            write_csource(filename=target_file,module_name=ext_name,doc=extension.doc,release_gil=extension.release_gil)
         extension.depends += [target_file]
         return sources + [target_file]
 
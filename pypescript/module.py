@@ -5,7 +5,7 @@ import sys
 import logging
 import importlib
 
-from .block import BlockMapping, DataBlock, SectionBlock
+from .block import BlockMapping, DataBlock, SectionBlock, TRACE_GET, TRACE_HAS, TRACE_SET, TRACE_DEL
 from .config import ConfigBlock, ConfigError
 from .libutils import ModuleDescription, syntax_description
 from . import syntax, section_names
@@ -75,8 +75,12 @@ class MetaModule(BaseMetaClass):
         - before ``functions`` calls, fills in :attr:`BaseModule.data_block` with values specified in :attr:`BaseModule._datablock_set`
         - after ``functions`` calls, duplicate entries of :attr:`BaseModule.data_block` with key pairs specified in :attr:`BaseModule._datablock_duplicate`
         - set module :attr:`BaseModule._state`
+        - if :attr:`BaseModule._profiler` is set (see :meth:`BasePipeline.set_profiler`), the two first steps are recorded
+          with categories 'datablock_set' and 'datablock_duplicate'
         - exceptions occuring in ``functions`` calls are complemented with module class and local name, for easy debugging
 
+        The two first steps follow :attr:`BaseModule._datablock_plan` (see :meth:`BaseModule.set_datablock_plan`), and are skipped if there is nothing to set or duplicate.
+
         Parameters
         ----------
         functions : dict
@@ -85,17 +89,21 @@ class MetaModule(BaseMetaClass):
         def make_wrapper(step, fun):
 
             def wrapper(self):
-                for key,value in self._datablock_set.items():
-                    self.data_block[key] = value
+                datablock_set, datablock_duplicate = self._datablock_plan
+                if datablock_set:
+                    if self._profiler is not None: start = self._profiler.start()
+                    self.data_block.set_items(datablock_set)
+                    if self._profiler is not None: self._profiler.stop(start,self.name,step,category='datablock_set')
 
                 try:
                     fun(self)
                 except Exception as exc:
                     raise RuntimeError('Exception in function {} of {} [{}].'.format(step,self.__class__.__name__,self.name)) from exc
 
-                for keyg,keyl in self._datablock_duplicate.items():
-                    if keyl in self.data_block:
-                        self.data_block[keyg] = self.data_block[keyl]
+                if datablock_duplicate:
+                    if self._profiler is not None: start = self._profiler.start()
+                    self.data_block.duplicate(datablock_duplicate)
+                    if self._profiler is not None: self._profiler.stop(start,self.name,step,category='datablock_duplicate')
 
                 self._state = step
 
@@ -128,7 +136,7 @@ class BaseModule(object,metaclass=MetaModule):
     """
     logger = logging.getLogger('BaseModule')
     _available_options = [syntax.module_base_dir,syntax.module_name,syntax.module_file,syntax.module_class,
-                            syntax.datablock_set,syntax.datablock_mapping,syntax.datablock_duplicate]
+                            syntax.datablock_set,syntax.datablock_mapping,syntax.datablock_duplicate,syntax.cache,syntax.speed]
 
     def __init__(self, name, options=None, config_block=None, data_block=None, description=None, pipeline=None):
         """
@@ -161,6 +169,8 @@ class BaseModule(object,metaclass=MetaModule):
         self.set_config_block(options=options,config_block=config_block)
         self.set_data_block(data_block=data_block)
         self._cache = {}
+        self._trace, self._tracing = {}, False
+        self._profiler = None
         self._pipeline = pipeline
         self._state = syntax.cleanup_function # start with cleanup, (nothing allocated)
 
@@ -172,6 +182,9 @@ class BaseModule(object,metaclass=MetaModule):
         - :attr:`_datablock_set`, dictionary of (key, value) to set into :attr:`data_block`
         - :attr:`_datablock_mapping`, :class:`BlockMapping` instance that maps :attr:`data_block` entries to others
         - :attr:'_datablock_duplicate', :class:`BlockMapping` instance used to duplicate :attr:`data_block` entries
+        - :attr:`_cache_depth`, number of :meth:`execute` results kept in :attr:`_cache` (option ``$cache``, see :meth:`ModuleTodo.__call__`)
+        - :attr:`speed`, speed tier (see :meth:`get_speed`)
+        - :attr:`_datablock_plan`, see :meth:`set_datablock_plan`
 
         Parameters
         ----------
@@ -189,8 +202,19 @@ class BaseModule(object,metaclass=MetaModule):
         self._datablock_set = {syntax.split_sections(key):value for key,value in syntax.collapse_sections(self.options.get_dict(syntax.datablock_set,{}),maxdepth=2).items()}
         self._datablock_mapping = BlockMapping(syntax.collapse_sections(self.options.get_dict(syntax.datablock_mapping,{})),sep=syntax.section_sep)
         self._datablock_duplicate = BlockMapping(syntax.collapse_sections(self.options.get_dict(syntax.datablock_duplicate,{})),sep=syntax.section_sep)
+        self._cache_depth = int(self.options.get(syntax.cache,0) or 0)
+        self.speed = self.get_speed()
+        self.set_datablock_plan()
         self.check_options()
 
+    def set_datablock_plan(self):
+        """
+        Set :attr:`_datablock_plan`, tuples of (key, value) of :attr:`_datablock_set` and (keyg, keyl) of :attr:`_datablock_duplicate`,
+        passed to :meth:`DataBlock.set_items` and :meth:`DataBlock.duplicate` around each step.
+        To be called again if :attr:`_datablock_set` or :attr:`_datablock_duplicate` are modified.
+        """
+        self._datablock_plan = (tuple(self._datablock_set.items()),tuple(self._datablock_duplicate.items()))
+
     def check_options(self):
         """Check provided options are mentioned in description file (if exists), else raises ``ConfigError``."""
         if self.description is not None:
@@ -230,8 +254,7 @@ class BaseModule(object,metaclass=MetaModule):
             :class:`DataBlock` instance used by the module to retrieve and store items.
             If ``None``, creates one.
         """
-        self.data_block = DataBlock(data_block)
-        self.data_block.set_mapping(self._datablock_mapping)
+        self.data_block = DataBlock(data_block,mapping=self._datablock_mapping)
 
     @property
     def mpicomm(self):
@@ -250,6 +273,72 @@ class BaseModule(object,metaclass=MetaModule):
         """Clean up, i.e. free variables if needed (called at the end)."""
         raise NotImplementedError
 
+    def get_speed(self):
+        """
+        Return speed tier of this module, used to group modules executed at different rates (e.g. 'slow' and 'fast'),
+        as given by option ``$speed``, else by the 'speed' entry of the module description, else ``None``.
+        """
+        description = self.description if self.description is not None else {}
+        return self.options.get(syntax.speed,description.get('speed',None))
+
+    def get_declared_io(self, steps=None):
+        """
+        Return sets of (section, name) keys read and written by ``steps`` (defaults to all steps) in the pipeline :class:`DataBlock`,
+        as declared by the module description ('inputs', 'outputs', '[step] input' and '[step] output' entries)
+        and options :attr:`_datablock_set` and :attr:`_datablock_duplicate`, translated with :attr:`_datablock_mapping`.
+        ``name`` is ``None`` if the whole section is concerned.
+        Return ``None`` if the module description does not provide any input or output.
+        """
+        all_steps = [syntax.setup_function,syntax.execute_function,syntax.cleanup_function]
+        if steps is None: steps = all_steps
+        description = self.description if self.description is not None else {}
+        if all(description.get(name,None) is None for name in ['inputs','outputs'] + ['{} {}'.format(step,io) for step in all_steps for io in ['input','output']]):
+            return None
+        mapping = self._datablock_mapping
+
+        def true_key(key):
+            # turn module key into pipeline key
+            key = syntax.split_sections(key,sep=syntax.section_sep)
+            section, name = key[0], syntax.join_sections(key[1:],sep=syntax.section_sep) if len(key) > 1 else None
+            if name is not None and (section,name) in mapping:
+                return tuple(mapping[section,name])
+            if section in mapping:
+                return (mapping[section][0],name)
+            return (section,name)
+
+        reads, writes = set(), set()
+        for step in steps:
+            for keys,name in zip([reads,reads,writes,writes],['inputs','{} input'.format(step),'outputs','{} output'.format(step)]):
+                entry = description.get(name,None) or []
+                if isinstance(entry,str): entry = [entry]
+                # description entries are either a list of keys, or a dictionary of section: {name: description}
+                if isinstance(entry,dict): entry = syntax.collapse_sections(entry,maxdepth=2,sep=None)
+                for key in entry:
+                    keys.add(true_key(key))
+        writes |= set(true_key(key) for key in self._datablock_set)
+        for keyg,keyl in self._datablock_duplicate.items():
+            reads.add(true_key(keyl))
+            writes.add(true_key(keyg))
+        return reads, writes
+
+    def get_traced_io(self, steps=None):
+        """
+        Return sets of (section, name) keys read and written by ``steps`` (defaults to all recorded steps) in the pipeline :class:`DataBlock`,
+        as recorded in :attr:`_trace` when :attr:`_tracing` (see :meth:`BasePipeline.set_trace`).
+        ``name`` is ``None`` if the whole section is concerned.
+        Return ``None`` if any of ``steps`` has not been recorded, or accessed the whole data dictionary (:attr:`DataBlock.data`).
+        """
+        if steps is None: steps = list(self._trace.keys())
+        reads, writes = set(), set()
+        for step in steps:
+            if step not in self._trace or None in self._trace[step]:
+                return None
+            for section,names in self._trace[step].items():
+                for name,flags in names.items():
+                    if flags & (TRACE_GET | TRACE_HAS): reads.add((section,name))
+                    if flags & (TRACE_SET | TRACE_DEL): writes.add((section,name))
+        return reads, writes
+
     def __str__(self):
         """String as module class name + module local name (in this pipeline)."""
         return '{} [{}]'.format(self.__class__.__name__,self.name)
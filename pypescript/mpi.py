@@ -247,11 +247,18 @@ class MPITaskManager(object):
 
     The main function is ``iterate`` which iterates through a set of tasks,
     distributing the tasks in parallel over the available ranks.
+
+    Tasks are distributed following ``schedule``:
+
+    - 'dynamic': the root sends chunks of ``chunksize`` tasks to workers as they get ready
+    - 'guided': same, with chunks of the number of remaining tasks divided by twice the number of workers (at least ``chunksize``)
+    - 'static': tasks are split into contiguous blocks, one per worker, without communication with the root
     """
+    schedules = ['dynamic','guided','static']
     logger = logging.getLogger('MPITaskManager')
 
     @CurrentMPIComm.enable
-    def __init__(self, nprocs_per_task=1, use_all_nprocs=False, mpicomm=None):
+    def __init__(self, nprocs_per_task=1, use_all_nprocs=False, persistent=False, work_on_root=False, schedule='dynamic', chunksize=1, mpicomm=None):
         """
         Initialize MPITaskManager.
 
@@ -267,9 +274,30 @@ class MPITaskManager(object):
             if `True`, use all available CPUs, including the remainder
             if `nprocs_per_task` does not divide the total number of CPUs
             evenly; default is `False`
+        persistent : bool, optional
+            if `True`, the split communicator is kept when exiting the context,
+            such that the task manager can be entered again without splitting
+            the base communicator; call ``free`` to release it; default is `False`
+        work_on_root : bool, optional
+            if `True`, the root rank also computes tasks (on its own),
+            at most `chunksize` at a time, whenever no worker is waiting for instructions;
+            default is `False`; only available with `nprocs_per_task` = 1
+        schedule : string, optional
+            how tasks are distributed over workers, 'dynamic', 'guided' or 'static'; default is 'dynamic'
+        chunksize : int, optional
+            number of tasks sent at once to a worker with 'dynamic' schedule,
+            minimum number with 'guided' schedule; default is 1
         """
         self.nprocs_per_task = nprocs_per_task
         self.use_all_nprocs  = use_all_nprocs
+        self.persistent = persistent
+        self.work_on_root = work_on_root
+        if work_on_root and nprocs_per_task > 1:
+            raise ValueError('work_on_root is only available with nprocs_per_task = 1, as the root computes tasks on its own')
+        if schedule not in self.schedules:
+            raise ValueError('Unknown schedule {}; should be in {}'.format(schedule,self.schedules))
+        self.schedule = schedule
+        self.chunksize = max(int(chunksize),1)
 
         # the base communicator
         self.basecomm = MPI.COMM_WORLD if mpicomm is None else mpicomm
@@ -292,9 +320,18 @@ class MPITaskManager(object):
     def __enter__(self):
         """
         Split the base communicator such that each task gets allocated
-        the specified number of nranks to perform the task with.
+        the specified number of nranks to perform the task with
+        (only the first time, if ``persistent``).
         """
+        if self.mpicomm is None:
+            self.split()
+        CurrentMPIComm.push(self.mpicomm)
+        return self
+
+    def split(self):
+        """Split the base communicator, see ``__enter__``."""
         self.self_worker_ranks = []
+        self.worker_index = None
         color = 0
         total_ranks = 0
         nworkers = 0
@@ -304,16 +341,22 @@ class MPITaskManager(object):
             if self.rank in ranks:
                 color = i+1
                 self.self_worker_ranks = ranks
+                self.worker_index = nworkers
             total_ranks += len(ranks)
             nworkers = nworkers + 1
+        if self.work_on_root and self.rank == 0:
+            # root gets its own task communicator
+            color = self.size + 1
+            self.self_worker_ranks = [0]
+            self.worker_index = nworkers
         self.other_ranks = [rank for rank in range(self.size) if rank not in self.self_worker_ranks]
 
         self.workers = nworkers # store the total number of workers
         if self.rank == 0:
-            self.logger.info('Entering {} with {:d} workers.'.format(self.__class__.__name__,self.workers))
+            self.logger.info('Entering {} with {:d} workers{}.'.format(self.__class__.__name__,self.workers,' and root' if self.work_on_root else ''))
 
         # check for no workers!
-        if self.workers == 0:
+        if self.workers == 0 and not self.work_on_root:
             raise ValueError('no pool workers available; try setting `use_all_nprocs` = True')
 
         leftover = (self.size - 1) - total_ranks
@@ -331,9 +374,6 @@ class MPITaskManager(object):
 
         # split the comm between the workers
         self.mpicomm = self.basecomm.Split(color, 0)
-        CurrentMPIComm.push(self.mpicomm)
-
-        return self
 
     def is_root(self):
         """
@@ -374,19 +414,20 @@ class MPITaskManager(object):
                 tag = self.status.Get_tag()
 
             # bcast to everyone in the worker subcomm
-            args  = self.mpicomm.bcast(args) # args is [task_number, task_value]
+            args  = self.mpicomm.bcast(args) # args is a list of [task_number, task_value]
             tag   = self.mpicomm.bcast(tag)
 
-            # yield the task
+            # yield the tasks
             if tag == self.tags.START:
 
-                # yield the task value
-                yield args
+                # yield the task values
+                for arg in args:
+                    yield arg
 
-                # wait for everyone in task group before telling master this task is done
+                # wait for everyone in task group before telling master this chunk is done
                 self.mpicomm.Barrier()
                 if self.mpicomm.rank == 0:
-                    self.basecomm.send([args[0], None], dest=0, tag=self.tags.DONE)
+                    self.basecomm.send([args[0][0], None], dest=0, tag=self.tags.DONE)
 
             # see ya later
             elif tag == self.tags.EXIT:
@@ -401,7 +442,10 @@ class MPITaskManager(object):
         self.logger.debug('rank %d process is done waiting',self.rank)
 
     def _distribute_tasks(self, tasks):
-        """Internal function that distributes the tasks from the root to the workers."""
+        """
+        Internal generator that distributes the tasks from the root to the workers.
+        If ``work_on_root``, yields the next available tasks (at most ``chunksize``) to the root when no worker is waiting for instructions.
+        """
 
         if not self.is_root():
             raise ValueError('only the root rank should distribute the tasks')
@@ -414,7 +458,17 @@ class MPITaskManager(object):
         self.logger.debug('master starting with {:d} worker(s) with {:d} total tasks'.format(self.workers, ntasks))
 
         # loop until all workers have finished with no more tasks
-        while closed_workers < self.workers:
+        while closed_workers < self.workers or (self.work_on_root and task_index < ntasks):
+
+            # no worker is waiting, so root computes the next tasks
+            # at most chunksize of them, whatever the schedule, so that workers waiting for instructions are not kept idle
+            if self.work_on_root and task_index < ntasks and not self.basecomm.Iprobe(source=MPI.ANY_SOURCE, tag=MPI.ANY_TAG):
+                chunk = [[index, tasks[index]] for index in range(task_index, min(task_index + self.chunksize, ntasks))]
+                self.logger.debug('root computing {:d} task(s) from task {:d}'.format(len(chunk),task_index))
+                task_index += len(chunk)
+                for this_task in chunk:
+                    yield this_task
+                continue
 
             # look for tags from the workers
             data = self.basecomm.recv(source=MPI.ANY_SOURCE, tag=MPI.ANY_TAG, status=self.status)
@@ -426,10 +480,10 @@ class MPITaskManager(object):
 
                 # still more tasks to compute
                 if task_index < ntasks:
-                    this_task = [task_index, tasks[task_index]]
-                    self.basecomm.send(this_task, dest=source, tag=self.tags.START)
-                    self.logger.debug('sending task `{}` to worker {:d}'.format(str(tasks[task_index]),source))
-                    task_index += 1
+                    chunk = self._get_chunk(tasks, task_index)
+                    self.basecomm.send(chunk, dest=source, tag=self.tags.START)
+                    self.logger.debug('sending {:d} task(s) from task {:d} to worker {:d}'.format(len(chunk),task_index,source))
+                    task_index += len(chunk)
 
                 # all tasks sent -- tell worker to exit
                 else:
@@ -444,6 +498,42 @@ class MPITaskManager(object):
                 closed_workers += 1
                 self.logger.debug('worker {:d} has exited, closed workers = {:d}'.format(source,closed_workers))
 
+    @property
+    def nworkers(self):
+        """Number of worker groups computing tasks, including the root if ``work_on_root``."""
+        return self.workers + bool(self.work_on_root)
+
+    def _get_chunk(self, tasks, task_index):
+        """Internal function that returns the next chunk of [task_number, task_value], starting at ``task_index``."""
+        chunksize = self.chunksize
+        if self.schedule == 'guided':
+            chunksize = max(-(-(len(tasks) - task_index) // (2*self.nworkers)), chunksize)
+        return [[index, tasks[index]] for index in range(task_index, min(task_index + chunksize, len(tasks)))]
+
+    def _get_static_tasks(self, tasks):
+        """Internal generator that yields the block of [task_number, task_value] of the current worker, with 'static' schedule."""
+        if self.worker_index is None:
+            return
+        ntasks = len(tasks)
+        start, stop = self.worker_index * ntasks // self.nworkers, (self.worker_index + 1) * ntasks // self.nworkers
+        for index in range(start, stop):
+            yield [index, tasks[index]]
+
+    def _get_own_tasks(self, tasks):
+        """Internal function that returns an iterator over the [task_number, task_value] to be computed by the current process."""
+        if self.schedule == 'static':
+            return self._get_static_tasks(tasks)
+
+        # master distributes the tasks and tracks closed workers
+        if self.is_root():
+            return self._distribute_tasks(tasks)
+
+        # workers will wait for instructions
+        if self.is_worker():
+            return self._get_tasks()
+
+        return []
+
     def iterate(self, tasks):
         """
         Iterate through a series of tasks in parallel.
@@ -464,14 +554,8 @@ class MPITaskManager(object):
         task :
             The individual items of `tasks`, iterated through in parallel.
         """
-        # master distributes the tasks and tracks closed workers
-        if self.is_root():
-            self._distribute_tasks(tasks)
-
-        # workers will wait for instructions
-        elif self.is_worker():
-            for tasknum, args in self._get_tasks():
-                yield args
+        for tasknum, args in self._get_own_tasks(list(tasks)):
+            yield args
 
     def map(self, function, tasks):
         """
@@ -499,24 +583,17 @@ class MPITaskManager(object):
         """
         results = []
 
-        # master distributes the tasks and tracks closed workers
-        if self.is_root():
-            self._distribute_tasks(tasks)
-
-        # workers will wait for instructions
-        elif self.is_worker():
-
-            # iterate through tasks in parallel
-            for tasknum, args in self._get_tasks():
+        # iterate through tasks in parallel
+        for tasknum, args in self._get_own_tasks(list(tasks)):
 
-                # make function arguments consistent with *args
-                if not isinstance(args, tuple):
-                    args = (args,)
+            # make function arguments consistent with *args
+            if not isinstance(args, tuple):
+                args = (args,)
 
-                # compute the result (only worker root needs to save)
-                result = function(*args)
-                if self.mpicomm.rank == 0:
-                    results.append((tasknum, result))
+            # compute the result (only worker root needs to save)
+            result = function(*args)
+            if self.mpicomm.rank == 0:
+                results.append((tasknum, result))
 
         # put the results in the correct order
         results = self.basecomm.allgather(results)
@@ -539,8 +616,14 @@ class MPITaskManager(object):
 
         CurrentMPIComm.pop()
 
+        if not self.persistent:
+            self.free()
+
+    def free(self):
+        """Free the split communicator."""
         if self.mpicomm is not None:
             self.mpicomm.Free()
+            self.mpicomm = None
 
 
 @CurrentMPIComm.enable
@@ -676,6 +759,84 @@ def gather_array(data, root=0, mpicomm=None):
     return recvbuffer
 
 
+def _get_byte_counts(nbytes, maxcount=2**30):
+    """
+    Return size (in bytes) of the unit in which to exchange ``nbytes`` of each rank, and counts and offsets (in units),
+    such that counts and offsets fit in 32-bit integers, as required by MPI. Units are multiples of 16 bytes.
+    """
+    unit = -(-max(-(-sum(nbytes) // maxcount), 1) // 16) * 16
+    counts = np.array([-(-nb // unit) for nb in nbytes], dtype='i')
+    offsets = np.zeros_like(counts)
+    offsets[1:] = counts.cumsum()[:-1]
+    return unit, counts, offsets
+
+
+@CurrentMPIComm.enable
+def allgather_values(values, mpicomm=None):
+    """
+    Gather the dictionaries ``values`` of all ranks, on all ranks, in two collective operations.
+    Numpy arrays (of non-object type) are concatenated in a byte buffer exchanged with ``Allgatherv``,
+    which avoids mpi4py pickling (and the 2 GB limit, using a custom datatype);
+    other values are pickled, along with array types and shapes, in a single ``allgather``.
+
+    Parameters
+    ----------
+    values : dict
+        the values on each rank to gather
+    mpicomm : MPI communicator
+        the MPI communicator
+
+    Returns
+    -------
+    values : dict
+        the union of ``values`` of all ranks; if a key is in ``values`` of several ranks,
+        the value of the lowest rank is kept
+    """
+    if mpicomm.size == 1:
+        return dict(values)
+
+    # arrays are aligned on 16 bytes in the buffer, to be viewed without copy
+    def padded(nbytes):
+        return -(-nbytes // 16) * 16
+
+    arrays, others = {}, {}
+    for key,value in values.items():
+        if isinstance(value, np.ndarray) and not value.dtype.hasobject:
+            arrays[key] = value if value.flags.c_contiguous else value.copy(order='C')
+        else:
+            others[key] = value
+
+    meta = [(key, array.dtype, array.shape) for key,array in arrays.items()]
+    gathered = mpicomm.allgather((meta, others))
+
+    nbytes = [sum(padded(dtype.itemsize * int(np.prod(shape))) for key,dtype,shape in meta_) for meta_,others_ in gathered]
+    unit, counts, offsets = _get_byte_counts(nbytes)
+
+    recvbuffer = np.empty(int(counts.sum()) * unit, dtype='u1')
+    if recvbuffer.size:
+        sendbuffer = np.zeros(int(counts[mpicomm.rank]) * unit, dtype='u1')
+        offset = 0
+        for array in arrays.values():
+            sendbuffer[offset:offset + array.nbytes] = array.reshape(-1).view('u1')
+            offset += padded(array.nbytes)
+        # setup the custom dtype, as in gather_array
+        dt = MPI.BYTE.Create_contiguous(unit)
+        dt.Commit()
+        mpicomm.Allgatherv([sendbuffer, dt], [recvbuffer, (counts, offsets), dt])
+        dt.Free()
+
+    toret = {}
+    for (meta_, others_), offset in zip(gathered, offsets.astype('i8') * unit):
+        for key,dtype,shape in meta_:
+            nbytes = dtype.itemsize * int(np.prod(shape))
+            if key not in toret:
+                toret[key] = recvbuffer[offset:offset + nbytes].view(dtype).reshape(shape)
+            offset += padded(nbytes)
+        for key,value in others_.items():
+            toret.setdefault(key, value)
+    return toret
+
+
 @CurrentMPIComm.enable
 def broadcast_array(data, root=0, mpicomm=None):
     """
@@ -1,18 +1,55 @@
 """Definition of :class:`BasePipeline` and subclasses."""
 
 import os
+import time
+import pickle
+import hashlib
 import logging
 import subprocess
+import multiprocessing
+from concurrent import futures
 
 import numpy as np
 
 from .module import BaseModule, MetaModule, _import_pygraphviz
-from . import syntax
-from . import utils
-from .block import BlockMapping, DataBlock, SectionBlock
+from . import syntax, section_names
+from . import utils, mpi
+from .block import BlockMapping, DataBlock, SectionBlock, TRACE_GET, TRACE_HAS, TRACE_SET, TRACE_DEL
 from .config import ConfigBlock, ConfigError
 
 
+_cache_missing = object() # marks (section, name) not in the data block
+
+
+_hash_types = (int,float,bool,complex,str,bytes,type(None),np.generic) # immutable scalars, hashed by value
+
+
+def _hash_value(value):
+    """
+    Return hashable representation of ``value``: digest of buffer for arrays, ``value`` (tagged with its type, such that e.g. ``1``, ``1.0``
+    and ``True`` differ) for immutable scalars, else digest of pickled ``value`` (as other objects may be modified in place).
+    """
+    if value is _cache_missing:
+        return value
+    if isinstance(value,np.ndarray) and not value.dtype.hasobject:
+        return (value.dtype.str,value.shape,hashlib.blake2b(np.ascontiguousarray(value),digest_size=16).digest())
+    if isinstance(value,_hash_types):
+        toret = (type(value),value)
+        try:
+            hash(toret)
+            return toret
+        except TypeError:
+            pass
+    return (type(value),hashlib.blake2b(pickle.dumps(value,protocol=pickle.HIGHEST_PROTOCOL),digest_size=16).digest())
+
+
+def _copy_cached(value):
+    """Return copy of ``value`` if it is an array (which may be modified in place), else ``value``."""
+    if isinstance(value,np.ndarray):
+        return value.copy()
+    return value
+
+
 class ModuleTodo(object):
     """
     Helper class to run module :meth:`BaseModule.setup`, :meth:`BaseModule.execute` and :meth:`BaseModule.cleanup`,
@@ -43,6 +80,7 @@ class ModuleTodo(object):
         self.pipeline = pipeline
         self.module = module
         self.step = step
+        self.ncalls, self.time = 0, 0.
 
     def __repr__(self):
         return 'ModuleTodo(pipeline=[{}],module=[{}],steps={})'.format(self.pipeline.name,self.module.name,self.todo())
@@ -55,13 +93,117 @@ class ModuleTodo(object):
         """Return list of steps to run."""
         return self._decision_tree[self.step][self.module._state]
 
+    def io(self, traced=True):
+        """
+        Return sets of :attr:`BasePipeline.pipe_block` (section, name) keys read and written by the steps to run,
+        as declared by the module (see :meth:`BaseModule.get_declared_io`), else, if ``traced``, as recorded (see :meth:`BaseModule.get_traced_io`).
+        ``name`` is ``None`` if the whole section is concerned.
+        Return ``None`` if unknown.
+        """
+        steps = self.todo()
+        toret = self.module.get_declared_io(steps)
+        # pipelines feed their modules with copies of their data_block, which are not traced
+        if toret is None and traced and not isinstance(self.module,BasePipeline):
+            toret = self.module.get_traced_io(steps)
+        return toret
+
+    def cache_key(self, block, inputs, outputs):
+        """
+        Return key identifying the values of ``inputs`` (section, name) keys in ``block``, excluding ``outputs``.
+        Arrays are hashed through their buffer, immutable scalars are used directly, and others are pickled.
+        Return ``None`` if some value cannot be hashed.
+        """
+        toret = []
+        for section,name in sorted(inputs - outputs,key=str):
+            if name is None:
+                if (section,None) in outputs or not block.has(section): continue
+                items = [(name,value) for (_,name),value in block.items(section) if (section,name) not in outputs]
+                items.sort(key=lambda item: str(item[0]))
+            elif block.has(section,name):
+                items = [(name,block[section,name])]
+            else:
+                items = [(name,_cache_missing)]
+            for name,value in items:
+                try:
+                    value = _hash_value(value)
+                except (TypeError,pickle.PicklingError,AttributeError):
+                    self.module.log_debug('Cannot hash {}.{}, {} not cached.'.format(section,name,self.module.name))
+                    return None
+                toret.append((section,name,value))
+        return tuple(toret)
+
     def __call__(self):
-        """Run module: set :attr:`BaseModule.data_block` and call module methods."""
+        """
+        Run module: set :attr:`BaseModule.data_block` and call module methods.
+        If the module has option ``$cache`` (``True`` or number of results to keep, in least recently used order)
+        and only 'execute' is to run, values of the keys read by the module (see :meth:`io`) in :attr:`BasePipeline.pipe_block`
+        are hashed; if they match those of a previous call, the module is not executed and values of the keys it wrote
+        at that call are set again in :attr:`BasePipeline.pipe_block`. Arrays are copied into and out of the cache, such that modules
+        modifying them in place do not alter cached results.
+        If the keys read and written by the module are unknown, they are recorded at the first call.
+        The number of calls and the total time spent are accumulated in :attr:`ncalls` and :attr:`time`;
+        if a profiler is set (see :meth:`BasePipeline.set_profiler`), each step is recorded, as well as cache lookups.
+        """
         todo = self.todo()
-        if todo:
-            self.set_data_block()
-            for step in todo:
-                getattr(self.module,step)()
+        if not todo:
+            return
+        t0 = time.perf_counter()
+        try:
+            self.run(todo)
+        finally:
+            self.ncalls += 1
+            self.time += time.perf_counter() - t0
+
+    def run(self, todo):
+        """Run module steps ``todo``, see :meth:`__call__`."""
+        module = self.module
+        self.set_data_block()
+        cache = module._cache_depth and todo == [syntax.execute_function]
+        if module._cache_depth and not cache:
+            module._cache.clear() # setup or cleanup may change results
+        key, tracing, profiler = None, module._tracing, module._profiler
+        if cache:
+            if profiler is not None: start = profiler.start()
+            # pipeline keys, without module mapping
+            block = DataBlock(self.pipeline.pipe_block,mapping={})
+            io = self.io()
+            if io is None:
+                tracing = True
+            else:
+                key = self.cache_key(block,*io)
+                if key is not None and key in module._cache:
+                    outputs = module._cache[key] = module._cache.pop(key) # most recently used
+                    for (section,name),value in outputs.items():
+                        if value is _cache_missing:
+                            if block.has(section,name): del block[section,name]
+                        else:
+                            block[section,name] = _copy_cached(value)
+                    if profiler is not None: profiler.stop(start,module.name,syntax.execute_function,category='cache')
+                    return
+            if profiler is not None: profiler.stop(start,module.name,syntax.execute_function,category='cache')
+        for step in todo:
+            if tracing:
+                module.data_block.set_trace(module._trace.setdefault(step,{}))
+            if profiler is not None:
+                with profiler(module.name,step):
+                    getattr(module,step)()
+            else:
+                getattr(module,step)()
+        if cache and io is None:
+            io = self.io() # now recorded; inputs are not expected to be modified by the module
+            if io is not None: key = self.cache_key(block,*io)
+        if key is not None:
+            outputs = {}
+            for section,name in io[1]:
+                if name is None:
+                    if block.has(section): outputs.update((key,_copy_cached(value)) for key,value in block.items(section))
+                elif block.has(section,name):
+                    outputs[section,name] = _copy_cached(block[section,name])
+                else:
+                    outputs[section,name] = _cache_missing
+            module._cache[key] = outputs
+            while len(module._cache) > module._cache_depth:
+                del module._cache[next(iter(module._cache))] # least recently used
 
 
 class MetaPipeline(MetaModule):
@@ -77,8 +219,12 @@ class MetaPipeline(MetaModule):
         - after ``functions`` calls, copy entries of :attr:`BasePipeline.pipe_block` into :attr:`BasePipeline.data_block`
           with key pairs specified in :attr:`BasePipeline._datablock_duplicate`
         - set pipeline :attr:`BasePipeline._state`
+        - arguments are passed to ``functions`` (e.g. ``changed_keys`` of :meth:`BasePipeline.execute`)
+        - if a profiler is set, the two first steps are recorded with categories 'datablock_set' and 'datablock_duplicate'
         - exceptions occuring in ``functions`` calls are complemented with module class and local name, for easy debugging
 
+        As for :class:`MetaModule`, the two first steps are skipped if there is nothing to set or duplicate.
+
         Parameters
         ----------
         functions : dict
@@ -86,22 +232,23 @@ class MetaPipeline(MetaModule):
         """
         def make_wrapper(step, fun):
 
-            def wrapper(self):
-                for key,value in self._datablock_set.items():
-                    self.data_block[key] = value
+            def wrapper(self, *args, **kwargs):
+                datablock_set, datablock_duplicate = self._datablock_plan
+                if datablock_set:
+                    if self._profiler is not None: start = self._profiler.start()
+                    self.data_block.set_items(datablock_set)
+                    if self._profiler is not None: self._profiler.stop(start,self.name,step,category='datablock_set')
 
                 try:
-                    fun(self)
+                    fun(self,*args,**kwargs)
                 except Exception as exc:
                     raise RuntimeError('Exception in function {} of {} [{}].'.format(step,self.__class__.__name__,self.name)) from exc
 
-                for keyg,keyl in self._datablock_duplicate.items():
-                    if keyg != keyl and keyl in self.data_block:
-                        #print('db',self.name,keyg,keyl,id(self.data_block[keyl]))
-                        self.data_block[keyg] = self.data_block[keyl]
-                    elif keyl in self.pipe_block: # because not necessarily present at each step...
-                        #print('pb',self.name,keyg,keyl,id(self.pipe_block[keyl]))
-                        self.data_block[keyg] = self.pipe_block[keyl]
+                if datablock_duplicate:
+                    if self._profiler is not None: start = self._profiler.start()
+                    # keyl is looked up in data_block if keyg != keyl, else in pipe_block (because not necessarily present at each step...)
+                    self.data_block.duplicate(datablock_duplicate,self.pipe_block)
+                    if self._profiler is not None: self._profiler.stop(start,self.name,step,category='datablock_duplicate')
 
                 self._state = step
 
@@ -190,6 +337,9 @@ class BasePipeline(BaseModule,metaclass=MetaPipeline):
         - :attr:`_datablock_set`, dictionary of (key, value) to set into :attr:`data_block`
         - :attr:`_datablock_mapping`, :class:`BlockMapping` instance that maps :attr:`data_block` entries to others
         - :attr:'_datablock_duplicate', :class:`BlockMapping` instance used to duplicate :attr:`data_block` entries
+        - :attr:`_cache_depth`, number of :meth:`execute` results kept in :attr:`_cache` (option ``$cache``)
+        - :attr:`speed`, speed tier (see :meth:`BaseModule.get_speed`)
+        - :attr:`_datablock_plan`, see :meth:`BaseModule.set_datablock_plan`
 
         Parameters
         ----------
@@ -215,6 +365,9 @@ class BasePipeline(BaseModule,metaclass=MetaPipeline):
                 datablock_duplicate = syntax.collapse_sections(datablock_duplicate,sep=syntax.section_sep)
             datablock_duplicate = {key:value if value is not None else key for key,value in datablock_duplicate.items()}
         self._datablock_duplicate = BlockMapping(datablock_duplicate,sep=syntax.section_sep)
+        self._cache_depth = int(self.options.get(syntax.cache,0) or 0)
+        self.speed = self.get_speed()
+        self.set_datablock_plan()
         #for key in self._datablock_bcast:
         #    self._datablock_duplicate[key] = key
         for module in self.modules.values():
@@ -283,10 +436,13 @@ class BasePipeline(BaseModule,metaclass=MetaPipeline):
         for todo in self.setup_todos:
             todo()
 
-    def execute(self):
-        """Execute :attr:`modules`, fed with :attr:`pipe_block`, a copy of :attr:`data_block`."""
-        self.pipe_block = self.data_block.copy()
-        for todo in self.execute_todos:
+    def execute(self, changed_keys=None):
+        """
+        Execute :attr:`modules`, fed with :attr:`pipe_block`, a copy of :attr:`data_block`.
+        If ``changed_keys`` is provided and the pipeline has already been executed, only the modules downstream of these keys
+        are executed (see :meth:`get_execute_todos`).
+        """
+        for todo in self.get_execute_todos(changed_keys):
             todo()
 
     def cleanup(self):
@@ -295,6 +451,195 @@ class BasePipeline(BaseModule,metaclass=MetaPipeline):
         for todo in self.cleanup_todos:
             todo()
 
+    def get_execute_todos(self, changed_keys=None, copy=True):
+        """
+        Set :attr:`pipe_block` for :meth:`execute` and return list of :class:`ModuleTodo` to run.
+
+        Parameters
+        ----------
+        changed_keys : list, default=None
+            (section, name) tuples, 'section.name' or 'section' strings, keys of :attr:`data_block` which changed since the last :meth:`execute`.
+            If ``None``, or if the pipeline has not been executed yet, :attr:`pipe_block` is set to (a copy of) :attr:`data_block`
+            and :attr:`execute_todos` is returned. Else, values of these keys are set in :attr:`pipe_block`,
+            which keeps the results of the previous :meth:`execute`, and todos downstream of these keys are returned (see :meth:`get_downstream_todos`).
+
+        copy : bool, default=True
+            Whether :attr:`pipe_block` is a copy of :attr:`data_block` (else :attr:`data_block` itself).
+        """
+        if changed_keys is None or self._state != syntax.execute_function:
+            self.pipe_block = self.data_block.copy() if copy else self.data_block
+            return self.execute_todos
+        changed_keys = _normalize_keys(changed_keys)
+        if not copy:
+            self.pipe_block = self.data_block
+        elif self.pipe_block is not self.data_block:
+            # without mappings
+            data_block, pipe_block = DataBlock(self.data_block,mapping={}), DataBlock(self.pipe_block,mapping={})
+            for section,name in changed_keys:
+                if name is None:
+                    if data_block.has(section):
+                        pipe_block[section] = {name:value for (_,name),value in data_block.items(section)}
+                    elif pipe_block.has(section):
+                        del pipe_block[section]
+                elif data_block.has(section,name):
+                    pipe_block[section,name] = data_block[section,name]
+                elif pipe_block.has(section,name):
+                    del pipe_block[section,name]
+        return self.get_downstream_todos(changed_keys)
+
+    def get_downstream_todos(self, changed_keys, todos=None):
+        """
+        Return list of :class:`ModuleTodo` of ``todos`` (defaults to :attr:`execute_todos`) to run when keys ``changed_keys``
+        (see :meth:`get_execute_todos`) changed, i.e. those reading (see :meth:`ModuleTodo.io`) these keys or keys written by previous todos to run.
+        If a todo has unknown inputs and outputs, it is run, as well as all next ones.
+        """
+        if todos is None: todos = self.execute_todos
+        changed = _normalize_keys(changed_keys)
+        toret = []
+        for itodo,todo in enumerate(todos):
+            io = todo.io()
+            if io is None:
+                return toret + todos[itodo:]
+            if _keys_overlap(io[0],changed):
+                toret.append(todo)
+                changed |= io[1]
+        return toret
+
+    def get_tiers(self, todos=None):
+        """
+        Return dictionary of speed tier (see :meth:`BaseModule.get_speed`): list of :class:`ModuleTodo` of ``todos``
+        (defaults to :attr:`execute_todos`), tiers being ordered by first appearance in ``todos``.
+        """
+        if todos is None: todos = self.execute_todos
+        toret = {}
+        for todo in todos:
+            toret.setdefault(todo.module.speed,[]).append(todo)
+        return toret
+
+    def get_tier_timings(self, todos=None):
+        """
+        Return dictionary of speed tier: time (in seconds) taken by the modules of this tier to run ``todos`` (defaults to :attr:`execute_todos`),
+        averaged over previous calls. Samplers can use the ratio of these timings to choose how often to update the keys
+        of each block returned by :meth:`get_speed_blocks`.
+        """
+        return {tier:sum(todo.time/todo.ncalls for todo in tier_todos if todo.ncalls) for tier,tier_todos in self.get_tiers(todos=todos).items()}
+
+    def get_speed_blocks(self, keys, todos=None):
+        """
+        Group keys (e.g. parameters, see ``changed_keys`` of :meth:`get_execute_todos`) by the speed tiers of the modules of ``todos``
+        (defaults to :attr:`execute_todos`) to run when they change (see :meth:`get_downstream_todos`).
+        Return list of (tiers, keys) tuples, starting with the keys which trigger the largest number of modules, typically the slowest ones.
+        """
+        if todos is None: todos = self.execute_todos
+        blocks = {}
+        for key in keys:
+            downstream = self.get_downstream_todos([key],todos=todos)
+            tiers = tuple(self.get_tiers(downstream).keys())
+            blocks.setdefault(tiers,[[],len(downstream)])[0].append(key)
+        return [(tiers,block[0]) for tiers,block in sorted(blocks.items(),key=lambda item: -item[1][1])]
+
+    def set_profiler(self, profiler=True, events=False):
+        """
+        Record the time and memory taken by each step of all modules (recursively) into :class:`~pypescript.utils.Profiler` ``profiler``;
+        if ``True``, a new one is created, keeping each call if ``events`` (the last ``events`` calls if an integer, see :class:`~pypescript.utils.Profiler`);
+        if ``None`` or ``False``, stop recording. Return ``profiler``.
+        Steps are recorded with category 'step' (which includes the other categories), and 'datablock_set', 'datablock_duplicate'
+        for the corresponding bookkeeping of :class:`MetaModule` and :class:`MetaPipeline` wrappers, 'cache' for ``$cache`` lookups.
+        """
+        if profiler is True:
+            profiler = utils.Profiler(events=events,mpicomm=self.mpicomm)
+        elif profiler is False:
+            profiler = None
+        self._profiler = profiler
+        for module in self.modules.values():
+            module._profiler = profiler
+            if isinstance(module,BasePipeline):
+                module.set_profiler(profiler)
+        return profiler
+
+    def checkpoint(self, filename):
+        """
+        Append a checkpoint of :attr:`pipe_block` to ``filename``, to be replayed by :meth:`DataBlock.restore` (see :meth:`DataBlock.checkpoint`).
+        :attr:`pipe_block` is a new copy of :attr:`data_block` at each :meth:`execute`, hence does not track modifications itself:
+        it is mirrored into a block kept across calls, where entries are set again only if they are not the same objects as at the previous checkpoint,
+        such that only the entries that changed since then are written.
+        """
+        block = getattr(self,'_checkpoint_block',None)
+        if block is None:
+            block = self._checkpoint_block = DataBlock(add_sections=[])
+            block.mpicomm = self.mpicomm
+        block.set_mapping(None)
+        keys = set()
+        for key,value in self.pipe_block.items():
+            keys.add(key)
+            if key not in block or block[key] is not value:
+                block[key] = value
+        for key in list(block.keys()):
+            if key not in keys: del block[key]
+        block.set_mapping(self.pipe_block.mapping)
+        block.checkpoint(filename)
+
+    def set_trace(self, trace=True, reset=False):
+        """
+        Start (if ``trace``) or stop recording the keys of :attr:`pipe_block` accessed by each module (recursively) at each step,
+        into :attr:`BaseModule._trace`. If ``reset``, forget previous records.
+        """
+        for module in self.modules.values():
+            module._tracing = trace
+            if reset: module._trace = {}
+            if isinstance(module,BasePipeline):
+                module.set_trace(trace=trace,reset=reset)
+
+    def get_trace(self):
+        """
+        Return list of (module name, step, section, name, accesses, declared) tuples recorded (see :meth:`set_trace`) for all modules (recursively),
+        where ``accesses`` is a comma-separated list of 'get', 'has', 'set' and 'del',
+        and ``declared`` is ``None`` if the module description does not list any input or output,
+        else whether these accesses are declared (see :meth:`BaseModule.get_declared_io`).
+        Inputs and outputs declared in the description but not accessed are listed with ``accesses = ''``.
+        """
+        toret = []
+        flag_names = [(TRACE_GET,'get'),(TRACE_HAS,'has'),(TRACE_SET,'set'),(TRACE_DEL,'del')]
+        for module in self.modules.values():
+            for step,sections in module._trace.items():
+                declared = module.get_declared_io([step])
+                used = [set(),set()]
+                for section,names in sections.items():
+                    for name,flags in names.items():
+                        accesses = ','.join(flag_name for flag,flag_name in flag_names if flags & flag)
+                        isdeclared = None
+                        if declared is not None:
+                            isdeclared = True
+                            for keys,usedkeys,mask in zip(declared,used,[TRACE_GET | TRACE_HAS,TRACE_SET | TRACE_DEL]):
+                                if flags & mask:
+                                    overlap = [key for key in keys if _keys_overlap([key],[(section,name)])]
+                                    usedkeys |= set(overlap)
+                                    isdeclared &= bool(overlap)
+                        toret.append((module.name,step,section,name,accesses,isdeclared))
+                if declared is not None:
+                    for keys,usedkeys in zip(declared,used):
+                        for section,name in sorted(keys - usedkeys,key=str):
+                            toret.append((module.name,step,section,name,'',True))
+            if isinstance(module,BasePipeline):
+                toret += module.get_trace()
+        return toret
+
+    def log_trace(self):
+        """Log table of recorded accesses (see :meth:`get_trace`), with a warning for each access not declared in module descriptions."""
+        trace = self.get_trace()
+        declared_str = {None:'no description',True:'declared',False:'undeclared'}
+        rows = [('module','step','section','name','accesses','description')]
+        for module,step,section,name,accesses,declared in trace:
+            if accesses == '': declared_str_ = 'declared, not accessed'
+            else: declared_str_ = declared_str[declared]
+            rows.append((module,step,section,'*' if name is None else name,accesses,declared_str_))
+        widths = [max(len(str(row[icol])) for row in rows) for icol in range(len(rows[0]))]
+        for row in rows:
+            self.log_info(' | '.join('{:<{}}'.format(str(value),width) for value,width in zip(row,widths)).rstrip(),rank=0)
+        for module,step,section,name,accesses,declared in trace:
+            if declared is False:
+                self.log_warning('Module [{}] {} accesses ({}) {}.{} which is not declared in its description.'.format(module,step,accesses,section,name),rank=0)
+
     def plot_pipeline_graph(self, filename):
         """Plot pipeline as a graph to ``filename``."""
         pgv = _import_pygraphviz()
@@ -328,10 +673,9 @@ class StreamPipeline(BasePipeline):
         for todo in self.setup_todos:
             todo()
 
-    def execute(self):
-        """Execute :attr:`modules`."""
-        self.pipe_block = self.data_block
-        for todo in self.execute_todos:
+    def execute(self, changed_keys=None):
+        """Execute :attr:`modules`, only those downstream of ``changed_keys`` if provided (see :meth:`BasePipeline.get_execute_todos`)."""
+        for todo in self.get_execute_todos(changed_keys,copy=False):
             todo()
 
     def cleanup(self):
@@ -341,6 +685,126 @@ class StreamPipeline(BasePipeline):
             todo()
 
 
+def _normalize_keys(keys):
+    """Return set of (section, name) keys (name being ``None`` for a whole section) from list of (section, name) tuples, 'section.name' or 'section' strings."""
+    toret = set()
+    for key in keys:
+        if isinstance(key,str):
+            key = syntax.split_sections(key,sep=syntax.section_sep)
+            key = (key[0],syntax.join_sections(key[1:],sep=syntax.section_sep) if len(key) > 1 else None)
+        elif len(key) == 1:
+            key = (key[0],None)
+        toret.add(tuple(key))
+    return toret
+
+
+def _keys_overlap(keys1, keys2):
+    """Whether (section, name) keys (name being ``None`` for a whole section) in ``keys1`` and ``keys2`` overlap."""
+    for section1,name1 in keys1:
+        for section2,name2 in keys2:
+            if section1 == section2 and (name1 is None or name2 is None or name1 == name2):
+                return True
+    return False
+
+
+class DAGPipeline(BasePipeline):
+    """
+    Extend :class:`BasePipeline` to run independent modules concurrently on a pool of threads.
+
+    Each list of :class:`ModuleTodo` is turned into a dependency graph: a module waits for all previous modules
+    which write what it reads or writes, or read what it writes, following the inputs and outputs declared in module descriptions.
+    Modules which do not declare them wait for all previous modules, and all next modules wait for them:
+    accesses recorded at previous executions (see :meth:`BaseModule.get_traced_io`) may not cover all code paths, hence are not trusted here.
+    As long as the GIL is held, Python modules do not run faster on threads; this is useful for compiled modules
+    which release it (``release_gil: true``, see :mod:`~pypescript.libutils.setup`), or Python modules spending time in e.g. numpy.
+
+    Attributes
+    ----------
+    nthreads : int
+        Number of threads. If 1, modules are run serially, in order (useful for debugging).
+    """
+    logger = logging.getLogger('DAGPipeline')
+    _available_options = BasePipeline._available_options + [syntax.nthreads]
+
+    def set_config_block(self, options=None, config_block=None):
+        super(DAGPipeline,self).set_config_block(options=options,config_block=config_block)
+        self.nthreads = self.options.get_int(syntax.nthreads,os.cpu_count() or 1)
+        self._graphs = {}
+
+    def get_graph(self, todos):
+        """
+        Return, for each todo of list ``todos``, the list of indices of the next todos that wait for it,
+        and the number of previous todos it waits for.
+        """
+        todo_steps = tuple((id(todo),tuple(todo.todo())) for todo in todos)
+        if todo_steps in self._graphs:
+            return self._graphs[todo_steps]
+        ios = [todo.io(traced=False) for todo in todos]
+        nexts, nprevs = [[] for todo in todos], [0 for todo in todos]
+        for itodo,todo in enumerate(todos):
+            for iprev in range(itodo):
+                prev, io, previo = todos[iprev], ios[itodo], ios[iprev]
+                if prev.module is todo.module or io is None or previo is None or _keys_overlap(previo[1],io[0])\
+                    or _keys_overlap(previo[1],io[1]) or _keys_overlap(previo[0],io[1]):
+                    nexts[iprev].append(itodo)
+                    nprevs[itodo] += 1
+        self._graphs[todo_steps] = toret = (nexts,nprevs)
+        return toret
+
+    def run_todos(self, todos):
+        """Run list of :class:`ModuleTodo`, independent ones concurrently."""
+        if self.nthreads <= 1 or len(todos) <= 1:
+            for todo in todos:
+                todo()
+            return
+        nexts, nprevs = self.get_graph(todos)
+        nprevs = list(nprevs)
+        if getattr(self,'_executor',None) is None:
+            self._executor = futures.ThreadPoolExecutor(max_workers=self.nthreads,thread_name_prefix=self.name)
+        pending, error = {}, None
+        for itodo,todo in enumerate(todos):
+            if nprevs[itodo] == 0:
+                pending[self._executor.submit(todo)] = itodo
+        while pending:
+            done = futures.wait(pending,return_when=futures.FIRST_COMPLETED)[0]
+            for future in done:
+                itodo = pending.pop(future)
+                exc = future.exception()
+                if exc is not None:
+                    if error is None: error = exc
+                    continue
+                if error is not None:
+                    continue # do not start new todos, wait for running ones
+                for inext in nexts[itodo]:
+                    nprevs[inext] -= 1
+                    if nprevs[inext] == 0:
+                        pending[self._executor.submit(todos[inext])] = inext
+        if error is not None:
+            raise error
+
+    def setup(self):
+        """Set up :attr:`modules`, fed with :attr:`pipe_block`, a copy of :attr:`data_block`."""
+        self.pipe_block = self.data_block.copy()
+        self.run_todos(self.setup_todos)
+
+    def execute(self, changed_keys=None):
+        """
+        Execute :attr:`modules`, fed with :attr:`pipe_block`, a copy of :attr:`data_block`,
+        only those downstream of ``changed_keys`` if provided (see :meth:`BasePipeline.get_execute_todos`).
+        """
+        self.run_todos(self.get_execute_todos(changed_keys))
+
+    def cleanup(self):
+        """Clean up :attr:`modules`, fed with :attr:`pipe_block`, a copy of :attr:`data_block`, then shut down threads."""
+        self.pipe_block = self.data_block.copy()
+        try:
+            self.run_todos(self.cleanup_todos)
+        finally:
+            if getattr(self,'_executor',None) is not None:
+                self._executor.shutdown()
+                self._executor = None
+
+
 def _make_callable_from_array(array):
 
     def func(i):
@@ -370,9 +834,25 @@ class MPIPipeline(BasePipeline):
     _datablock_key_iter : dict
         Mapping of :attr:`data_block` entry, to list of :attr:`data_block` keys,
         pointing to the :attr:`data_block` entry the where to store result for all iterations.
+
+    persistent_workers : bool
+        If ``True``, the task manager (and its split MPI communicators) is kept across :meth:`execute` calls,
+        and only re-created by :meth:`setup` and :meth:`cleanup`; values of :attr:`data_block` with a method ``mpi_distribute``
+        are only distributed again to the workers if they changed (i.e. were set to a different object) since the previous call.
+
+    work_on_root : bool
+        If ``True``, the root rank, which distributes the tasks to the other ranks, also executes tasks (at most :attr:`chunksize` at a time) when no worker is waiting for one.
+        Only available with ``nprocs_per_task = 1``.
+
+    schedule : string
+        How tasks are distributed over workers: 'dynamic' (chunks of :attr:`chunksize` tasks sent to workers as they get ready, the default),
+        'guided' (chunks of decreasing size, at least :attr:`chunksize`) or 'static' (one contiguous block of tasks per worker, without communication).
+
+    chunksize : int
+        Number of tasks sent at once to a worker with 'dynamic' :attr:`schedule`, minimum number with 'guided' :attr:`schedule`.
     """
     logger = logging.getLogger('MPIPipeline')
-    _available_options = BasePipeline._available_options + [syntax.iter,syntax.nprocs_per_task,syntax.configblock_iter,syntax.datablock_iter,syntax.datablock_key_iter]
+    _available_options = BasePipeline._available_options + [syntax.iter,syntax.nprocs_per_task,syntax.persistent_workers,syntax.work_on_root,syntax.schedule,syntax.chunksize,syntax.configblock_iter,syntax.datablock_iter,syntax.datablock_key_iter]
 
     def set_iter(self):
         self._iter = self.options.get(syntax.iter,None)
@@ -380,6 +860,10 @@ class MPIPipeline(BasePipeline):
             # most certainly the number of iterations
             self._iter = range(self._iter)
         self.nprocs_per_task = self.options.get_int(syntax.nprocs_per_task,1)
+        self.persistent_workers = self.options.get_bool(syntax.persistent_workers,False)
+        self.work_on_root = self.options.get_bool(syntax.work_on_root,False)
+        self.schedule = self.options.get_string(syntax.schedule,'dynamic')
+        self.chunksize = self.options.get_int(syntax.chunksize,1)
         for block_name in ['configblock_iter','datablock_iter','datablock_key_iter']:
             block_keyword = getattr(syntax,block_name)
             block_iter = {}
@@ -411,9 +895,11 @@ class MPIPipeline(BasePipeline):
                 self._datablock_bcast += tmp
             for key in self._datablock_bcast:
                 self._datablock_duplicate[key] = key
+            self.set_datablock_plan()
 
     def setup(self):
         """Set up :attr:`modules`, fed with :attr:`pipe_block`, a copy of :attr:`data_block`."""
+        self.free_task_manager()
         self.set_iter()
         super(MPIPipeline,self).setup()
 
@@ -421,6 +907,54 @@ class MPIPipeline(BasePipeline):
         """Execute :attr:`modules`, fed with :attr:`pipe_block`, a copy of :attr:`data_block`, for all iterations."""
         self.run_iter(self.execute_todos)
 
+    def cleanup(self):
+        """Clean up :attr:`modules`, fed with :attr:`pipe_block`, a copy of :attr:`data_block`, then free the task manager."""
+        try:
+            super(MPIPipeline,self).cleanup()
+        finally:
+            self.free_task_manager()
+
+    def get_task_manager(self):
+        """Return task manager to run iterations, kept in :attr:`_task_manager` if :attr:`persistent_workers`."""
+        tm = getattr(self,'_task_manager',None)
+        if tm is None:
+            tm = utils.TaskManager(nprocs_per_task=self.nprocs_per_task,persistent=self.persistent_workers,work_on_root=self.work_on_root,
+                                   schedule=self.schedule,chunksize=self.chunksize,mpicomm=self.mpicomm)
+            if self.persistent_workers:
+                self._task_manager, self._distributed = tm, {}
+        return tm
+
+    def free_task_manager(self):
+        """Free task manager kept by :meth:`get_task_manager`, with its communicators and distributed values."""
+        tm = getattr(self,'_task_manager',None)
+        if tm is not None:
+            tm.free()
+        self._task_manager, self._distributed = None, {}
+
+    def distribute_data_block(self, tm):
+        """
+        Return copy of :attr:`data_block` distributed on the workers of task manager ``tm``.
+        If :attr:`persistent_workers`, distributed values are kept in :attr:`_distributed`,
+        and only values that are not the same objects as in the previous call are distributed again.
+        """
+        data_block = self.data_block.copy()
+        if not self.persistent_workers:
+            return data_block.mpi_distribute(dests=tm.self_worker_ranks,mpicomm=tm.mpicomm)
+        distributed = self._distributed # key: (value, distributed value)
+        keys = [key for key,value in data_block.items() if hasattr(value,'mpi_distribute') and (key not in distributed or distributed[key][0] is not value)]
+        # mpi_distribute is collective: all ranks must distribute the same values
+        keys = sorted(set().union(*tm.basecomm.allgather(keys)),key=str)
+        for key in keys:
+            value = data_block[key]
+            distributed[key] = (value,value.mpi_distribute(dests=tm.self_worker_ranks,mpicomm=tm.mpicomm))
+        for key in list(distributed.keys()):
+            if key in data_block:
+                data_block[key] = distributed[key][1]
+            else:
+                del distributed[key]
+        data_block[section_names.mpi,'comm'] = tm.mpicomm
+        return data_block
+
     def run_iter(self, todos):
         """Run list of :class:`ModuleTodo` for all iterations."""
         pipe_block = self.pipe_block = self.data_block.copy()
@@ -433,9 +967,9 @@ class MPIPipeline(BasePipeline):
             #    for task in self._iter:
             #        print(key,value(task))
 
-            with utils.TaskManager(nprocs_per_task=self.nprocs_per_task,mpicomm=self.mpicomm) as tm:
+            with self.get_task_manager() as tm:
 
-                data_block = self.data_block.copy().mpi_distribute(dests=tm.self_worker_ranks,mpicomm=tm.mpicomm)
+                data_block = self.distribute_data_block(tm)
 
                 for itask,task in tm.iterate(list(enumerate(self._iter))):
                     self.pipe_block = data_block.copy()
@@ -454,38 +988,26 @@ class MPIPipeline(BasePipeline):
                         #key_to_ranks[key] = tm.mpicomm.allgather(tm.basecomm.rank)
                         key_to_ranks[key] = tm.basecomm.rank
 
-                tm.basecomm.Barrier()
+                # ranks holding each (section, name), and class of values to be collected with mpi_collect, in one allgather
+                owned = {key:pipe_block[key] for key in self._datablock_bcast if key_to_ranks[key] is not None}
+                gathered = tm.basecomm.allgather({key:value.__class__ if hasattr(value,'mpi_collect') else None for key,value in owned.items()})
+                key_to_ranks, key_to_cls = {}, {}
+                for rank,keys in enumerate(gathered):
+                    for key,cls in keys.items():
+                        key_to_ranks.setdefault(key,[]).append(rank)
+                        if cls is not None: key_to_cls[key] = cls
                 for key in self._datablock_bcast:
-                    ranks = tm.basecomm.allgather(key_to_ranks[key])
-                    ranks = [r for r in ranks if r is not None]
-                    if not ranks:
+                    if key not in key_to_ranks:
                         raise RuntimeError('(section, name) = {} has not been added to pipe_block'.format(key))
-                    #elif len(ranks) > 1:
-                    #    raise RuntimeError('(section, name) = {} has been used {} times'.format(key,len(ranks)))
-                    #key_to_ranks[key] = ranks[0]
-                    key_to_ranks[key] = ranks
 
-                #tm.basecomm.Barrier()
+                # other values are sent by the root of each task communicator, in one exchange
+                values = {key:value for key,value in owned.items() if key not in key_to_cls} if tm.mpicomm.rank == 0 else {}
+                values = mpi.allgather_values(values,mpicomm=tm.basecomm)
                 for key in self._datablock_bcast:
-                    cls = None
-                    if tm.basecomm.rank in key_to_ranks[key]:
-                        toranks = tm.other_ranks
-                        value = pipe_block[key]
-                        if hasattr(value,'mpi_collect'):
-                            cls = value.__class__
-                            if tm.basecomm.rank == key_to_ranks[key][0]:
-                                for rank in toranks:
-                                    tm.basecomm.send(cls,dest=rank,tag=41)
-                        elif tm.basecomm.rank == key_to_ranks[key][0]:
-                            for rank in toranks:
-                                tm.basecomm.send(None,dest=rank,tag=41)
-                                tm.basecomm.send(value,dest=rank,tag=42)
-                    else:
-                        cls = tm.basecomm.recv(source=key_to_ranks[key][0],tag=41)
-                        if cls is None:
-                            pipe_block[key] = tm.basecomm.recv(source=key_to_ranks[key][0],tag=42)
-                    if cls is not None:
-                        pipe_block[key] = cls.mpi_collect(pipe_block.get(*key,None),sources=key_to_ranks[key],mpicomm=tm.basecomm)
+                    if key in key_to_cls:
+                        pipe_block[key] = key_to_cls[key].mpi_collect(pipe_block.get(*key,None),sources=key_to_ranks[key],mpicomm=tm.basecomm)
+                    elif tm.basecomm.rank not in key_to_ranks[key]:
+                        pipe_block[key] = values[key]
 
                 self.pipe_block = pipe_block
 
@@ -496,6 +1018,23 @@ class BatchError(Exception):
     """Exception raised when issue with batch job."""
 
 
+def _execute_batch_task(task, save):
+    """
+    Run subpipeline in a :class:`BatchPipeline` pool worker, as ``pypescript`` on the command line would.
+    ``task`` is the pickled (raw configuration dictionary, :class:`DataBlock` state); return state of output :class:`DataBlock` if ``save``, else ``None``.
+    Workers are spawned (not forked) Python processes, hence run with their own, single-process, MPI communicator.
+    """
+    config, state = pickle.loads(task)
+    data_block = DataBlock.from_state(state)
+    data_block[section_names.mpi,'comm'] = mpi.CurrentMPIComm.get()
+    pipeline = BasePipeline(config_block=ConfigBlock(config),data_block=data_block)
+    pipeline.setup()
+    pipeline.execute()
+    toret = pipeline.pipe_block.__getstate__() if save else None
+    pipeline.cleanup()
+    return toret
+
+
 
 class BatchPipeline(MPIPipeline):
     """
@@ -518,9 +1057,19 @@ class BatchPipeline(MPIPipeline):
 
     job_options : dict
         Options for job.
+
+    executor : string
+        'pool' to run tasks concurrently in a pool of :attr:`nworkers` processes started at :meth:`setup`, configuration and :class:`DataBlock` instances being sent through pipes
+        (the default if the pipeline runs on a single MPI process, :attr:`nprocs_per_task` is 1 and no :attr:`job_template` is provided).
+        Workers are spawned, not forked, such that they do not inherit the MPI state (nor threads) of the pipeline process;
+        'subprocess' to run each task with the ``pypescript`` command line (with :attr:`mpiexec` if :attr:`nprocs_per_task` > 1) or a job script, one after the other.
+
+    nworkers : int
+        Number of processes of the 'pool' :attr:`executor`; defaults to the number of CPUs (at most the number of tasks).
     """
     logger = logging.getLogger('BatchPipeline')
-    _available_options = MPIPipeline._available_options + [syntax.mpiexec,syntax.hpc_job_dir,syntax.hpc_job_submit,syntax.hpc_job_template,syntax.hpc_job_options]
+    _executors = ['pool','subprocess']
+    _available_options = MPIPipeline._available_options + [syntax.executor,syntax.nworkers,syntax.mpiexec,syntax.hpc_job_dir,syntax.hpc_job_submit,syntax.hpc_job_template,syntax.hpc_job_options]
 
     def __init__(self, *args, **kwargs):
         super(BatchPipeline,self).__init__(*args,**kwargs)
@@ -541,7 +1090,34 @@ class BatchPipeline(MPIPipeline):
             self.job_options = self.options.get_dict(syntax.hpc_job_options,{})
         else:
             self.job_template = None
+        self.free_pool()
         super(BatchPipeline,self).setup()
+        default = 'pool' if self.job_template is None and self.nprocs_per_task == 1 and self.mpicomm.size == 1 else 'subprocess'
+        self.executor = self.options.get_string(syntax.executor,default)
+        if self.executor not in self._executors:
+            raise ConfigError('Unknown {} {}; should be one of {}.'.format(syntax.executor,self.executor,self._executors))
+        if self.executor == 'pool' and default != 'pool':
+            raise ConfigError('{} pool cannot run tasks with job template or on several MPI processes, nor within an MPI run on several processes; use subprocess.'.format(syntax.executor))
+        if self.executor == 'pool':
+            ntasks = 1 if self._iter is None else len(self._iter)
+            self.nworkers = self.options.get_int(syntax.nworkers,min(os.cpu_count() or 1,ntasks))
+            self.log_info('Starting {:d} workers.'.format(self.nworkers))
+            self._pool = multiprocessing.get_context('spawn').Pool(self.nworkers)
+
+    def cleanup(self):
+        """Clean up :attr:`modules`, then terminate the pool of workers."""
+        try:
+            super(BatchPipeline,self).cleanup()
+        finally:
+            self.free_pool()
+
+    def free_pool(self):
+        """Terminate pool of workers started by :meth:`setup`, if any."""
+        pool = getattr(self,'_pool',None)
+        if pool is not None:
+            pool.terminate()
+            pool.join()
+        self._pool = None
 
     def find_file_task(self, filetype, itask=None):
         """
@@ -554,7 +1130,7 @@ class BatchPipeline(MPIPipeline):
         if filetype == 'config_block':
             base, ext = filetype, 'yaml'
         elif filetype in ['data_block','save_data_block']:
-            base, ext = filetype, 'npy'
+            base, ext = filetype, syntax.block_file_extension[1:]
         elif filetype == 'job':
             base, ext = 'script', 'job'
         else:
@@ -592,6 +1168,12 @@ class BatchPipeline(MPIPipeline):
         output = output.decode('utf-8')
         self.log_info('Output is:\n{}'.format(output),rank=0)
 
+    def submit_task(self, itask=0):
+        """Submit single task number ``itask`` to the pool of workers; return :class:`multiprocessing.pool.AsyncResult`."""
+        # pickle now, as iconfig_block and ipipe_block are updated for the next task
+        task = pickle.dumps((self.iconfig_block.raw,self.ipipe_block.__getstate__()),protocol=pickle.HIGHEST_PROTOCOL)
+        return self._pool.apply_async(_execute_batch_task,(task,bool(self.is_datablock_saved)))
+
     def load_task(self, itask=0):
         """
         Load subpipeline output :class:`DataBlock` instance for task number ``itask`` from disk.
@@ -607,7 +1189,10 @@ class BatchPipeline(MPIPipeline):
         return data_block
 
     def execute(self):
-        """Execute subpipeline for each task, either using the command line, or by executing a job script (if ``job_template`` is provided)."""
+        """
+        Execute subpipeline for each task, either concurrently in the pool of workers (if :attr:`executor` is 'pool'),
+        or one after the other using the command line, or by executing a job script (if ``job_template`` is provided).
+        """
         self.iconfig_block = self.config_block.copy()
         options = {}
         options[syntax.execute] = [syntax.join_sections((todo.module.name,todo.step),sep=syntax.module_function_sep) for todo in self.execute_todos]
@@ -622,6 +1207,7 @@ class BatchPipeline(MPIPipeline):
         iter = self._iter
         if self._iter is None: iter = [None]
 
+        results = []
         for task in iter:
 
             for key,value in self._configblock_iter.items():
@@ -629,11 +1215,22 @@ class BatchPipeline(MPIPipeline):
             for key,value in self._datablock_iter.items():
                 self.ipipe_block[key] = value(task)
 
-            self.execute_task(task)
+            if self.executor == 'pool':
+                results.append(self.submit_task(task))
+            else:
+                self.execute_task(task)
+
+        if self.executor == 'pool':
+            try:
+                states = [result.get() for result in results]
+            except Exception as exc:
+                raise BatchError('Task failed: {}'.format(exc)) from exc
+            pipe_blocks = [DataBlock.from_state(state) if state is not None else None for state in states]
+        else:
+            pipe_blocks = (self.load_task(task) for task in iter)
 
         self.pipe_block = pipe_block = self.data_block.copy()
-        for itask,task in enumerate(iter):
-            pipe_block = self.load_task(task)
+        for itask,pipe_block in enumerate(pipe_blocks):
             for keyg,keyl in self._datablock_key_iter.items():
                 self.pipe_block[keyl[itask]] = pipe_block[keyg]
         for key in set(self._datablock_duplicate) - set(self._datablock_bcast): # bcast treated above
@@ -24,6 +24,7 @@ section_sep = '.'
 module_function_sep = ':'
 module_reference = '&'
 block_save_extension = '.npy'
+block_file_extension = '.block'
 main = 'main'
 setup_function = 'setup'
 execute_function = 'execute'
@@ -34,8 +35,8 @@ copy_if_datablock_copy = '_copy_if_datablock_copy'
 _keyword_names = ['module_base_dir','module_name','module_file','module_class',\
 'datablock_set','datablock_mapping','datablock_duplicate',
 'modules','setup','execute','cleanup',\
-'iter','nprocs_per_task','configblock_iter','datablock_iter','datablock_key_iter',\
-'mpiexec','hpc_job_dir','hpc_job_submit','hpc_job_template','hpc_job_options']
+'nthreads','cache','speed','iter','nprocs_per_task','persistent_workers','work_on_root','schedule','chunksize','configblock_iter','datablock_iter','datablock_key_iter',\
+'executor','nworkers','mpiexec','hpc_job_dir','hpc_job_submit','hpc_job_template','hpc_job_options']
 _keywords = {}
 
 # add keywords to local dictionary
@@ -324,11 +325,11 @@ class Decoder(UserDict):
                             mv = re.match(datablock_duplicate_re_pattern,value)
                             if mv:
                                 _duplicate[key_datablock] = mv.group(1)
-                                break
+                                continue
                             mv = re.match(datablock_mapping_re_pattern,value)
                             if mv:
                                 _mapping[key_datablock] = mv.group(1)
-                                break
+                                continue
                         _set[key_datablock] = value
                     elif isinstance(value,dict):
                         toret[key] = callback(value)
@@ -0,0 +1,54 @@
+"""Microbenchmarks of :class:`DataBlock` accesses, run with ``python bench_block.py``."""
+
+import timeit
+
+from pypescript.block import BlockMapping, DataBlock
+
+
+def bench(stmt, number=200000, repeat=5, **kwargs):
+    """Return best time per call of ``stmt``, in ns."""
+    return min(timeit.repeat(stmt,number=number,repeat=repeat,globals=kwargs))/number*1e9
+
+
+def bench_get_set(mapping=None, nsections=10, nnames=10):
+    """Return get and set ns/op for a :class:`DataBlock` with ``mapping``."""
+    block = DataBlock({'section_{:d}'.format(isection):{'name_{:d}'.format(iname):iname for iname in range(nnames)} for isection in range(nsections)},add_sections=[])
+    block.set_mapping(BlockMapping(mapping))
+    toret = {}
+    toret['get'] = bench('block["section_0","name_0"]',block=block)
+    toret['set'] = bench('block["section_0","name_0"] = 1',block=block)
+    toret['has'] = bench('("section_0","name_0") in block',block=block)
+    toret['get()'] = bench('block.get("section_0","name_0")',block=block)
+    toret['get() default'] = bench('block.get("section_0","name_{:d}",default=1)'.format(nnames),block=block)
+    toret['set()'] = bench('block.set("section_0","name_0",1)',block=block)
+    toret['has()'] = bench('block.has("section_0","name_0")',block=block)
+    if mapping:
+        toret['get alias'] = bench('block["alias","name_0"]',block=block)
+        toret['set alias'] = bench('block["alias","name_0"] = 1',block=block)
+    return toret
+
+
+def bench_block(nsections=1000, nnames=100):
+    """Return ns/op of whole-block operations for a :class:`DataBlock` with ``nsections`` sections of ``nnames`` entries."""
+    data = {'section_{:d}'.format(isection):{'name_{:d}'.format(iname):iname for iname in range(nnames)} for isection in range(nsections)}
+    block = DataBlock(data)
+    toret = {}
+    toret['init'] = bench('DataBlock(data)',number=20,data=data,DataBlock=DataBlock)
+    toret['copy'] = bench('block.copy()',number=1000,block=block)
+    toret['update'] = bench('new.update(block)',number=1000,block=block,new=DataBlock())
+    toret['iter'] = bench('for key in block: pass',number=20,block=block)
+    toret['keys'] = bench('for key in block.keys(): pass',number=20,block=block)
+    toret['items'] = bench('for key,value in block.items(): pass',number=20,block=block)
+    toret['setdefault'] = bench('block.setdefault("section_0","name_0",1)',block=block)
+    return toret
+
+
+if __name__ == '__main__':
+
+    for label,mapping in zip(['no mapping','name mapping','section mapping'],
+                             [None,{('alias','name_0'):('section_1','name_1')},{'alias':'section_1'}]):
+        toret = bench_get_set(mapping=mapping)
+        print('{}: {}'.format(label,', '.join('{} {:.1f} ns/op'.format(key,value) for key,value in toret.items())))
+
+    toret = bench_block()
+    print('1000 sections x 100 names: {}'.format(', '.join('{} {:.3g} us/op'.format(key,value/1e3) for key,value in toret.items())))
@@ -0,0 +1,51 @@
+"""Benchmarks of :class:`MPITaskManager` schedules on synthetic tasks, run with ``mpiexec -n 4 python bench_mpi.py``."""
+
+import time
+
+import numpy as np
+
+from pypescript.mpi import MPI, MPITaskManager
+
+
+def work(cost):
+    """Busy-wait for ``cost`` seconds."""
+    t0 = time.perf_counter()
+    while time.perf_counter() - t0 < cost: pass
+    return cost
+
+
+def bench_schedule(costs, repeat=3, mpicomm=None, **kwargs):
+    """Return best wall time (in s) to map :func:`work` on ``costs`` with :class:`MPITaskManager` options ``kwargs``."""
+    mpicomm = mpicomm or MPI.COMM_WORLD
+    tm = MPITaskManager(mpicomm=mpicomm,**kwargs)
+    toret = []
+    for i in range(repeat):
+        mpicomm.Barrier()
+        t0 = time.perf_counter()
+        with tm:
+            tm.map(work,costs)
+        toret.append(time.perf_counter() - t0)
+    return min(toret)
+
+
+if __name__ == '__main__':
+
+    mpicomm = MPI.COMM_WORLD
+    ntasks, cost = 2000, 1e-4
+    rng = np.random.RandomState(seed=42)
+    costs = {'uniform':[cost]*ntasks,
+             'skewed':list(cost*rng.pareto(1.5,size=ntasks)),
+             'increasing':list(np.linspace(0.,2.*cost,ntasks))}
+    schedules = {'dynamic':{'schedule':'dynamic'},
+                 'dynamic chunksize 20':{'schedule':'dynamic','chunksize':20},
+                 'guided':{'schedule':'guided'},
+                 'static':{'schedule':'static'},
+                 'dynamic work on root':{'schedule':'dynamic','work_on_root':True},
+                 'static work on root':{'schedule':'static','work_on_root':True}}
+
+    for label,costs_ in costs.items():
+        ideal = sum(costs_)/(mpicomm.size - 1)
+        for schedule,kwargs in schedules.items():
+            toret = bench_schedule(costs_,mpicomm=mpicomm,**kwargs)
+            if mpicomm.rank == 0:
+                print('{:d} {} tasks, {}: {:.3g} s (ideal with {:d} workers {:.3g} s)'.format(ntasks,label,schedule,toret,mpicomm.size-1,ideal))
@@ -0,0 +1,42 @@
+"""Benchmarks of :class:`DataBlock` accesses, run with ``pytest test_benchmark_block.py`` (requires pytest-benchmark)."""
+
+import pytest
+
+from pypescript.block import DataBlock
+
+pytest.importorskip('pytest_benchmark')
+
+
+@pytest.fixture(params=[None,{('alias','name_0'):('section_1','name_1')},{'alias':'section_1'}],ids=['no mapping','name mapping','section mapping'])
+def block(request):
+    toret = DataBlock({'section_{:d}'.format(isection):{'name_{:d}'.format(iname):iname for iname in range(10)} for isection in range(10)},add_sections=[])
+    toret.set_mapping(request.param)
+    return toret
+
+
+def test_getitem(benchmark, block):
+    benchmark(block.__getitem__,('section_0','name_0'))
+
+
+def test_setitem(benchmark, block):
+    benchmark(block.__setitem__,('section_0','name_0'),1)
+
+
+def test_contains(benchmark, block):
+    benchmark(block.__contains__,('section_0','name_0'))
+
+
+def test_get(benchmark, block):
+    benchmark(block.get,'section_0','name_0')
+
+
+def test_get_default(benchmark, block):
+    benchmark(block.get,'section_0','name_10',default=1)
+
+
+def test_set(benchmark, block):
+    benchmark(block.set,'section_0','name_0',1)
+
+
+def test_has(benchmark, block):
+    benchmark(block.has,'section_0','name_0')
@@ -1,10 +1,14 @@
+import os
+import tempfile
+
 import numpy as np
 import pytest
 
-from pypescript.block import BlockMapping, DataBlock, SectionBlock
+from pypescript.block import BlockMapping, DataBlock, SectionBlock, array_conversions, is_block_file, block_shard_filename, compact_checkpoint, TRACE_GET, TRACE_HAS, TRACE_SET, TRACE_DEL
 from pypescript.config import ConfigBlock
-from pypescript.utils import setup_logging, MemoryMonitor
+from pypescript.utils import setup_logging, MemoryMonitor, ScatteredBaseClass
 from pypescript import syntax
+from pypescript.__main__ import main as pypescript_main
 
 
 def test_mapping():
@@ -46,6 +50,8 @@ def test_mapping():
     assert str(mapping) == '{}'
     with pytest.raises(AttributeError):
         mapping.data = {'section_c':'section_d'}
+    with pytest.raises(TypeError):
+        mapping.data['section_c'] = ('section_d',)
 
 
 def test_block():
@@ -134,6 +140,455 @@ def test_block():
     #test['b'] = test
 
 
+def test_mapping_cache():
+    block = DataBlock({'section_a':{'name_a':1,'name_b':2},'section_b':{'name_a':3}},add_sections=[])
+    mapping = BlockMapping({('section_c','name_a'):('section_a','name_b')})
+    block.set_mapping(mapping)
+    for i in range(2):
+        assert block['section_c','name_a'] == 2
+        assert block['section_a','name_a'] == 1
+    # the mapping is modified in place, resolved entries must be updated
+    mapping['section_c','name_a'] = ('section_b','name_a')
+    assert block['section_c','name_a'] == 3
+    mapping['section_c'] = ('section_a',)
+    del mapping['section_c','name_a']
+    assert block['section_c','name_a'] == 1
+    block['section_c','name_c'] = 4
+    assert block['section_a','name_c'] == 4
+    # BlockMapping sharing the same dictionary
+    other = BlockMapping(mapping)
+    block.set_mapping(other)
+    assert block['section_c','name_b'] == 2
+    mapping.clear()
+    assert ('section_c','name_b') not in block
+    block.set_mapping(BlockMapping({'section_c':'section_b'}))
+    assert block['section_c','name_a'] == 3
+    block_copy = block.copy()
+    block_copy.set_mapping({})
+    assert ('section_c','name_a') not in block_copy
+    assert block['section_c','name_a'] == 3
+    with pytest.raises(TypeError):
+        block[['section_c'],'name_a']
+
+
+def test_copy_on_write():
+
+    class Hooked(object):
+
+        _copy_if_datablock_copy = True
+
+        def __init__(self, value):
+            self.value = value
+
+        def copy(self):
+            return self.__class__(self.value)
+
+    block = DataBlock({'section_a':{'name_a':1},'section_b':{'name_b':2},'section_c':{'name_c':3}},add_sections=[])
+    block_copy = block.copy(nocopy=['section_c'])
+    assert isinstance(block_copy,DataBlock)
+    assert block_copy.mapping is block.mapping
+    block_copy['section_a','name_a'] = 2
+    assert block['section_a','name_a'] == 1
+    block['section_b','name_b'] = 3
+    assert block_copy['section_b','name_b'] == 2
+    block_copy['section_c','name_c'] = 4
+    assert block['section_c','name_c'] == 4
+    # copy of copy
+    block_copy2 = block_copy.copy(nocopy=[])
+    del block_copy2['section_b','name_b']
+    assert ('section_b','name_b') in block_copy
+    block_copy2.clear(section='section_a')
+    assert block_copy['section_a'] == {'name_a':2}
+    block_copy2['section_a'] = {'name_d':4}
+    assert block_copy['section_a'] == {'name_a':2}
+    del block_copy2['section_a']
+    assert 'section_a' in block_copy
+    # sections obtained through get() are not shared with copies made afterwards
+    section_a = block['section_a']
+    block_copy = block.copy()
+    section_a['name_e'] = 5
+    assert block['section_a','name_e'] == 5
+    assert ('section_a','name_e') not in block_copy
+    block_copy['section_a']['name_f'] = 6
+    assert ('section_a','name_f') not in block
+    # DataBlock instances sharing the same data
+    block_copy = block.copy()
+    block_alias = DataBlock(block)
+    block_alias['section_b','name_b'] = 4
+    assert block['section_b','name_b'] == 4
+    assert block_copy['section_b','name_b'] == 3
+    # hook
+    block['section_a','hooked'] = Hooked(1)
+    block_copy = block.copy()
+    assert block_copy['section_a','hooked'] is not block['section_a','hooked']
+    assert block_copy['section_a','hooked'].value == 1
+    assert block_copy.copy()['section_a','hooked'] is not block_copy['section_a','hooked']
+    block['section_d'] = {'hooked':Hooked(2)}
+    assert block.copy()['section_d','hooked'] is not block['section_d','hooked']
+    block.update({'section_e':{'hooked':Hooked(3)}})
+    assert block.copy()['section_e','hooked'] is not block['section_e','hooked']
+    data = block.data
+    data['section_b']['hooked'] = Hooked(4)
+    assert block.copy()['section_b','hooked'] is not block['section_b','hooked']
+    data['section_f'] = {'hooked':Hooked(5)}
+    assert block.copy()['section_f','hooked'] is not block['section_f','hooked']
+    # sections of the data dictionary handed out before a copy are not shared with the copy
+    block = DataBlock({'a':{'x':1}},add_sections=[])
+    d = block.data
+    c = block.copy()
+    d['a']['x'] = 99
+    assert c['a','x'] == 1
+    c2 = c.copy()
+    c['a','x'] = 2
+    assert c2['a','x'] == 1 and block['a','x'] == 99
+
+
+def test_iter():
+    block = DataBlock({'section_a':{'name_a':1,'name_b':2},'section_b':{'name_c':3},'section_c':{}})
+    assert list(block) == block.keys()
+    assert list(block) == [('section_a','name_a'),('section_a','name_b'),('section_b','name_c'),('mpi','comm')]
+    assert syntax.common_sections[0] in block.sections()
+    it = iter(block)
+    next(it)
+    block['section_a','name_a'] = 4 # no size change
+    assert next(it) == ('section_a','name_b')
+    block['section_d'] = {}
+    with pytest.raises(RuntimeError):
+        next(it)
+    block.setdefault('section_a','name_a',5)
+    assert block['section_a','name_a'] == 4
+    block.setdefault('section_e','name_e',5)
+    assert block['section_e','name_e'] == 5
+    # default nocopy: common sections
+    block_copy = block.copy()
+    assert block_copy[syntax.common_sections[0]] is block[syntax.common_sections[0]]
+    assert block_copy['section_a'] is not block['section_a']
+    block_update = DataBlock(add_sections=[])
+    block_update.update(block)
+    assert block_update[syntax.common_sections[0]] is not block[syntax.common_sections[0]]
+    block_update = DataBlock()
+    block_update.update(block)
+    assert block_update[syntax.common_sections[0]] is block[syntax.common_sections[0]]
+
+
+def test_views():
+    block = DataBlock({'section_a':{'name_a':1,'name_b':2},'section_b':{'name_c':3}},mapping={'section_c':'section_a'},add_sections=[])
+    del block['mpi']
+    keys, items, values = block.keys(), block.items(), block.values()
+    assert len(keys) == len(items) == len(values) == 3
+    assert keys == [('section_a','name_a'),('section_a','name_b'),('section_b','name_c')]
+    assert items == [(('section_a','name_a'),1),(('section_a','name_b'),2),(('section_b','name_c'),3)]
+    assert list(values) == [1,2,3]
+    assert ('section_a','name_b') in keys and ('section_c','name_b') not in keys and 'section_a' not in keys
+    assert (('section_b','name_c'),3) in items and (('section_b','name_c'),2) not in items
+    assert 2 in values and 4 not in values
+    block['section_b','name_d'] = 4
+    assert len(keys) == 4 and ('section_b','name_d') in keys
+    keys = block.keys(section='section_b')
+    assert keys == [('section_b','name_c'),('section_b','name_d')] and len(keys) == 2
+    assert ('section_a','name_a') not in keys
+    assert block.values('section_b') == [3,4]
+    with pytest.raises(KeyError):
+        block.keys(section='section_c')
+    for key,value in block.items():
+        block[key] = value + 1
+    assert block.values() == [2,3,4,5]
+
+
+def test_arguments():
+    block = DataBlock({'section_a':{'name_a':1}},add_sections=[])
+    assert block.get('section_a','name_a') == block.get(section='section_a',name='name_a') == block['section_a','name_a'] == 1
+    assert block.get('section_a','name_b',2) == block.get('section_a',name='name_b',default=2) == block['section_a','name_b',2] == 2
+    assert block.get('section_a') == block.get(section='section_a') == block['section_a'] == block[('section_a',)] == {'name_a':1}
+    assert block.get('section_b',default=3) == 3
+    assert block.has('section_a','name_a') and block.has(section='section_a',name='name_a') and block.has('section_a')
+    assert 'section_a' in block and ('section_a',) in block and not block.has('section_a','name_b')
+    for args,kwargs in [((),{}),(('section_a','name_a',1,2),{}),(('section_a',),{'section':'section_a'}),(('section_a',),{'other':1})]:
+        with pytest.raises(TypeError):
+            block.get(*args,**kwargs)
+    with pytest.raises(TypeError):
+        block.set('section_a')
+    with pytest.raises(TypeError):
+        block['section_a','name_a','name_b'] = 1
+    block.set('section_a','name_b',2)
+    block.set('section_b',{'name_c':3})
+    assert block['section_a','name_b'] == 2 and block['section_b','name_c'] == 3
+    del block['section_a','name_a']
+    del block['section_b']
+    assert block['section_a'] == {'name_b':2} and 'section_b' not in block
+
+
+def test_array_conversions():
+    # Conversions are counted by compiled modules only
+    array_conversions(reset=True)
+    block = DataBlock({'section_a':{'name_a':np.ones(4,dtype='f4')}})
+    block.get('section_a','name_a')
+    assert array_conversions() == 0
+
+
+def test_trace():
+    block = DataBlock({'section1':{'name1':1}},mapping={'alias':'section2'})
+    trace = {}
+    block.set_trace(trace)
+    assert block.trace is trace
+    block['section1','name1']
+    block.get('section1','name2',None)
+    ('section1','name1') in block
+    block['alias','name1'] = 2
+    block.set('section1','name1',3)
+    del block['section2','name1']
+    block['section3'] = {'name1':1}
+    copy = block.copy()
+    copy['section1','name1']
+    assert copy.trace is None
+    assert trace == {'section1':{'name1':TRACE_GET | TRACE_HAS | TRACE_SET,'name2':TRACE_GET},'section2':{'name1':TRACE_SET | TRACE_DEL},
+                     'section3':{None:TRACE_SET}}
+    block.set_trace(None)
+    block['section1','name3'] = 1
+    assert block.trace is None and 'name3' not in trace['section1']
+    # section dictionaries, views and data
+    block = DataBlock({'a':{'x':1},'b':{'y':2},'c':{'z':3}},add_sections=[])
+    trace = {}
+    block.set_trace(trace)
+    block['a']['x'] = 5
+    list(block.items('b'))
+    list(block)
+    ('c','z') in block.keys()
+    assert trace == {'a':{None:TRACE_GET | TRACE_SET | TRACE_HAS},'b':{None:TRACE_GET | TRACE_HAS},'c':{None:TRACE_HAS,'z':TRACE_HAS},'mpi':{None:TRACE_HAS}}
+    trace.clear()
+    block.data['b']['y'] = 3
+    assert trace[None] == {None:TRACE_GET | TRACE_SET} and trace['b'] == {None:TRACE_GET | TRACE_SET}
+    with pytest.raises(TypeError):
+        block.set_trace([])
+
+
+def test_set_duplicate():
+    block = DataBlock({'section1':{'name1':1}},mapping={'alias':'section2'})
+    block.set_items(((('alias','name1'),2),('section3',{'name1':3})))
+    assert block['section2','name1'] == 2 and block['section3','name1'] == 3
+    block.duplicate(((('section1','name2'),('section1','name1')),(('section1','name3'),('section1','name4')),(('section4',),('section3',))))
+    assert block['section1','name2'] == 1 and ('section1','name3') not in block and block['section4','name1'] == 3
+    source = DataBlock({'section1':{'name1':4,'name4':5}})
+    block.duplicate(((('section1','name1'),('section1','name1')),(('section1','name2'),('section1','name1')),(('section1','name3'),('section1','name4'))),source)
+    assert block['section1','name1'] == 4 and block['section1','name2'] == 4 and block['section1','name3'] == 5
+    with pytest.raises(TypeError):
+        block.set_items([1])
+    with pytest.raises(TypeError):
+        block.duplicate([],{})
+
+
+def test_save_load():
+
+    data = {'parameters':{'a':1,'b':2.5,'c':'c','d':None,'e':(1,2)},'arrays':{'x':np.linspace(0.,1.,11),'y':np.arange(12,dtype='i4').reshape(3,4)[:,::2],
+            'z':np.array(2.),'w':np.array([None,1])},'dict':{'v':{'a':np.ones(3),'b':[1]}}}
+    block = DataBlock(data,mapping={('parameters','f'):('parameters','a')})
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        fn = os.path.join(tmp_dir,'data_block{}'.format(syntax.block_file_extension))
+        block.save(fn)
+        assert is_block_file(fn)
+        for mmap_mode in ['c',None]:
+            new = DataBlock.load(fn,mmap_mode=mmap_mode)
+            assert new['parameters','f'] == 1
+            for key,value in block.items():
+                if key == ('mpi','comm'): continue
+                if isinstance(value,np.ndarray):
+                    assert np.all(new[key] == value) and new[key].dtype == value.dtype and new[key].shape == value.shape
+                else:
+                    assert type(new[key]) is type(value)
+            assert new['parameters','e'] == (1,2) and new['parameters','d'] is None
+            assert isinstance(new['arrays','x'],np.memmap) == (mmap_mode is not None)
+            assert new['arrays','x'].ctypes.data % 64 == 0
+            new['arrays','x'][0] = 42.
+        assert DataBlock(fn)['arrays','x'][0] == 0.
+        new = DataBlock.load(fn,shared=True)
+        assert np.all(new['arrays','y'] == block['arrays','y'])
+        fn = os.path.join(tmp_dir,'data_block{}'.format(syntax.block_save_extension))
+        block.save(fn)
+        assert not is_block_file(fn)
+        assert np.all(DataBlock.load(fn)['arrays','x'] == block['arrays','x'])
+
+
+class FakeWin(object):
+
+    nfree = 0
+
+    @classmethod
+    def Allocate_shared(cls, size, disp_unit, comm=None):
+        new = cls()
+        new.memory = bytearray(max(size,1))
+        return new
+
+    def Shared_query(self, rank):
+        return self.memory, 1
+
+    def Free(self):
+        FakeWin.nfree += 1
+
+
+class FakeComm(object):
+
+    # two ranks on the same node, seen from rank 0
+    rank, size = 0, 2
+
+    def Split_type(self, split_type, key=0):
+        return FakeComm()
+
+    def bcast(self, obj, root=0):
+        return obj
+
+    def allgather(self, obj):
+        return [obj]*self.size
+
+    def Barrier(self):
+        pass
+
+    def Free(self):
+        pass
+
+
+def test_load_shared(monkeypatch):
+
+    from pypescript import block as block_module
+    monkeypatch.setattr(block_module.MPI,'Win',FakeWin,raising=False)
+    monkeypatch.setattr(block_module.MPI,'COMM_TYPE_SHARED',0,raising=False)
+    block = DataBlock({'arrays':{'x':np.linspace(0.,1.,11)}})
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        fn = os.path.join(tmp_dir,'data_block{}'.format(syntax.block_file_extension))
+        block.save(fn)
+        nwindows, FakeWin.nfree = len(block_module.shared_windows), 0
+        new = DataBlock.load(fn,shared=True,mpicomm=FakeComm())
+        assert np.all(new['arrays','x'] == block['arrays','x']) and not new['arrays','x'].flags.writeable
+        x = new['arrays','x']
+        for i in range(3):
+            new = DataBlock.load(fn,shared=True,mpicomm=FakeComm())
+            assert np.all(new['arrays','x'] == block['arrays','x'])
+        # windows are freed at the next load after being released: that of the second load only, as x holds the first one
+        assert FakeWin.nfree == 1 and len(block_module.shared_windows) == nwindows + 3
+        del x, new
+        block_module.free_shared_windows(mpicomm=FakeComm())
+        assert FakeWin.nfree == 4 and len(block_module.shared_windows) == nwindows
+
+
+class Scattered(ScatteredBaseClass):
+
+    pass
+
+
+def test_save_load_scattered():
+
+    block = DataBlock({'section':{'scattered':Scattered(x=np.arange(4.),mpistate='scattered'),'gathered':Scattered(x=np.ones(2)),'y':np.zeros(3)}})
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        fn = os.path.join(tmp_dir,'data_block{}'.format(syntax.block_file_extension))
+        block.save(fn)
+        assert is_block_file(block_shard_filename(fn,block.mpicomm.rank))
+        new = DataBlock.load(fn)
+        assert new['section','scattered'].is_mpi_scattered() and not new['section','gathered'].is_mpi_scattered()
+        assert np.all(new['section','scattered'].attrs['x'] == block['section','scattered'].attrs['x'])
+        assert np.all(new['section','y'] == block['section','y'])
+
+
+class PlainValue(object):
+
+    def __init__(self, x):
+        self.x = x
+
+    def __eq__(self, other):
+        return type(other) is type(self) and other.x == self.x
+
+
+def test_state_values():
+    # only values with from_state have their state stored; other objects (which all have __getstate__ in python >= 3.11) are kept as is
+    block = DataBlock({'section':{'plain':PlainValue(1),'gathered':Scattered(x=np.ones(2)),'set':{1,2}}})
+    state = block.__getstate__()['data']['section']
+    assert state['plain'] is block['section','plain'] and state['set'] == {1,2}
+    assert state['gathered']['__class__'] is Scattered and np.all(state['gathered']['__dict__']['attrs']['x'] == 1.)
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        for extension in [syntax.block_file_extension,syntax.block_save_extension]:
+            fn = os.path.join(tmp_dir,'data_block{}'.format(extension))
+            block.save(fn)
+            new = DataBlock.load(fn)
+            assert new['section','plain'] == PlainValue(1) and new['section','set'] == {1,2}
+            assert type(new['section','gathered']) is Scattered and np.all(new['section','gathered'].attrs['x'] == 1.)
+
+
+class CountingScattered(Scattered):
+
+    ngetstate = 0
+
+    def __getstate__(self):
+        CountingScattered.ngetstate += 1
+        return super(CountingScattered,self).__getstate__()
+
+
+def test_save_scattered_non_root():
+
+    class RankComm(FakeComm):
+        rank = 1
+
+    block = DataBlock({'section':{'scattered':CountingScattered(x=np.arange(4.),mpistate='scattered'),'gathered':CountingScattered(x=np.ones(2))}})
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        fn = os.path.join(tmp_dir,'data_block{}'.format(syntax.block_file_extension))
+        CountingScattered.ngetstate = 0
+        block.save(fn)
+        # root encodes the scattered entry for its shard, then the gathered one for the main file
+        assert CountingScattered.ngetstate == 2
+        os.remove(fn)
+        block.mpicomm, CountingScattered.ngetstate = RankComm(), 0
+        block.save(fn)
+        # non-root ranks only encode their scattered entries
+        assert CountingScattered.ngetstate == 1
+        assert not os.path.exists(fn) and is_block_file(block_shard_filename(fn,1))
+
+
+def test_checkpoint():
+
+    def assert_equal(new, block):
+        assert set(new.sections()) == set(block.sections())
+        for key,value in block.items():
+            if key == ('mpi','comm'): continue
+            assert np.all(new[key] == value)
+        assert new['parameters','f'] == block['parameters','a']
+
+    block = DataBlock({'parameters':{'a':1,'b':2.},'arrays':{'x':np.linspace(0.,1.,11)},'other':{'c':'c'}},mapping={('parameters','f'):('parameters','a')})
+    assert block.dirty is None
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        fn = os.path.join(tmp_dir,'checkpoint{}'.format(syntax.block_file_extension))
+        block.checkpoint(fn)
+        assert block.dirty == {}
+        assert_equal(DataBlock.restore(fn),block)
+        size = os.path.getsize(fn)
+        block['parameters','a'] = 2
+        del block['parameters','b']
+        block['arrays','y'] = np.arange(4)
+        assert block.dirty == {'parameters':{'a','b'},'arrays':{'y'}}
+        block.checkpoint(fn)
+        assert os.path.getsize(fn) < 2*size
+        del block['other']
+        block['new','d'] = np.ones(3)
+        block.checkpoint(fn)
+        block.clear()
+        block['parameters','a'] = 3
+        block.checkpoint(fn)
+        for mmap_mode in ['c',None]:
+            new = DataBlock.restore(fn,mmap_mode=mmap_mode)
+            assert_equal(new,block)
+        block['parameters','e'] = 4
+        block.checkpoint(fn)
+        with open(fn,'ab') as file:
+            file.write(b'\0'*100)
+        assert_equal(DataBlock.restore(fn),block)
+        size = os.path.getsize(fn)
+        compact_checkpoint(fn)
+        assert os.path.getsize(fn) < size
+        assert_equal(DataBlock.restore(fn),block)
+        block['parameters','e'] = 5
+        block.checkpoint(fn)
+        size = os.path.getsize(fn)
+        pypescript_main(['--compact-checkpoint',fn])
+        assert os.path.getsize(fn) < size
+        assert_equal(DataBlock.restore(fn),block)
+
+
 def test_sections():
     d = {'section_a':{'name_a':{'answer':42}},'section_b':{'name_b':2}}
     block = DataBlock(d,add_sections=[])
@@ -160,6 +615,19 @@ if __name__ == '__main__':
         for i in range(2000):
             test_mapping()
             test_block()
+            test_mapping_cache()
+            test_copy_on_write()
+            test_iter()
+            test_views()
+            test_arguments()
+            test_array_conversions()
+            test_trace()
+            test_set_duplicate()
+            test_save_load()
+            test_save_load_scattered()
+            test_state_values()
+            test_save_scattered_non_root()
+            test_checkpoint()
             test_sections()
 
     test_config()
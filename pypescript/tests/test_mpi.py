@@ -0,0 +1,237 @@
+import threading
+
+import numpy as np
+import pytest
+
+from pypescript import mpi
+from pypescript.mpi import MPI
+from pypescript.utils import setup_logging
+
+
+class ThreadWorld(object):
+
+    """State shared by the ranks of a :class:`ThreadComm`, each rank running in its own thread."""
+
+    def __init__(self, size):
+        self.size = size
+        self.barrier = threading.Barrier(size,timeout=10)
+        self.slots = [None]*size
+        self.condition = threading.Condition()
+        self.messages = [[] for rank in range(size)]
+
+
+class ThreadStatus(object):
+
+    source, tag = 0, 0
+
+    def Get_source(self):
+        return self.source
+
+    def Get_tag(self):
+        return self.tag
+
+
+class ThreadComm(object):
+
+    """Communicator between threads, implementing the subset of the mpi4py interface used by :mod:`pypescript.mpi`."""
+
+    def __init__(self, world, rank):
+        self.world = world
+        self.rank = rank
+        self.size = world.size
+
+    def allgather(self, obj):
+        self.world.slots[self.rank] = obj
+        self.world.barrier.wait()
+        toret = list(self.world.slots)
+        self.world.barrier.wait()
+        return toret
+
+    def bcast(self, obj, root=0):
+        return self.allgather(obj)[root]
+
+    def gather(self, obj, root=0):
+        toret = self.allgather(obj)
+        return toret if self.rank == root else None
+
+    def allreduce(self, obj, op=None):
+        return sum(self.allgather(obj))
+
+    def Barrier(self):
+        self.allgather(None)
+
+    barrier = Barrier
+
+    def Split(self, color=0, key=0):
+        colors = self.allgather((color,key))
+        ranks = sorted((key_,rank) for rank,(color_,key_) in enumerate(colors) if color_ == color)
+        # lowest rank of each color creates the new world
+        world = ThreadWorld(len(ranks)) if ranks[0][1] == self.rank else None
+        world = self.allgather(world)[ranks[0][1]]
+        return ThreadComm(world,[rank for key_,rank in ranks].index(self.rank))
+
+    def Free(self):
+        pass
+
+    def _match(self, source, tag):
+        for message in self.world.messages[self.rank]:
+            if source in (MPI.ANY_SOURCE,message[0]) and tag in (MPI.ANY_TAG,message[1]):
+                return message
+        return None
+
+    def send(self, obj, dest=0, tag=0):
+        with self.world.condition:
+            self.world.messages[dest].append((self.rank,tag,obj))
+            self.world.condition.notify_all()
+
+    def recv(self, source=MPI.ANY_SOURCE, tag=MPI.ANY_TAG, status=None):
+        with self.world.condition:
+            if not self.world.condition.wait_for(lambda: self._match(source,tag) is not None,timeout=10):
+                raise RuntimeError('rank {:d} timed out waiting for a message'.format(self.rank))
+            message = self._match(source,tag)
+            self.world.messages[self.rank].remove(message)
+        if status is not None:
+            status.source, status.tag = message[:2]
+        return message[2]
+
+    def Iprobe(self, source=MPI.ANY_SOURCE, tag=MPI.ANY_TAG):
+        with self.world.condition:
+            return self._match(source,tag) is not None
+
+    def Allgatherv(self, send, recv):
+        sendbuffer, recvbuffer, (counts, offsets) = send[0], recv[0], recv[1]
+        unit = recvbuffer.nbytes // int(np.sum(counts))
+        for rank,buffer in enumerate(self.allgather(sendbuffer.view('u1'))):
+            recvbuffer.view('u1')[offsets[rank]*unit:offsets[rank]*unit + buffer.size] = buffer
+
+
+def run_ranks(size, func):
+    """Run ``func(mpicomm)`` on ``size`` ranks of a :class:`ThreadComm`, and return the list of results."""
+    world = ThreadWorld(size)
+    results, errors = [None]*size, []
+
+    def run(rank):
+        try:
+            results[rank] = func(ThreadComm(world,rank))
+        except BaseException as exc:
+            errors.append(exc)
+            world.barrier.abort()
+
+    threads = [threading.Thread(target=run,args=(rank,)) for rank in range(size)]
+    for thread in threads: thread.start()
+    for thread in threads: thread.join()
+    if errors:
+        raise errors[0]
+    return results
+
+
+def test_byte_counts():
+    unit, counts, offsets = mpi._get_byte_counts([32,0,48])
+    assert unit == 16 and counts.tolist() == [2,0,3] and offsets.tolist() == [0,2,2]
+    nbytes = [3*2**31,2**33,16]
+    unit, counts, offsets = mpi._get_byte_counts(nbytes)
+    assert unit % 16 == 0 and all(count*unit >= nb for count,nb in zip(counts,nbytes))
+    assert counts.dtype.itemsize == 4 and int(counts.sum()) < 2**31 and np.all(np.diff(offsets) == counts[:-1])
+
+
+def test_allgather_values():
+
+    def func(mpicomm):
+        rank = mpicomm.rank
+        values = {'array{:d}'.format(rank):np.arange(rank + 1.),'common':np.full(3,rank),'other{:d}'.format(rank):rank,
+                  'strided':np.arange(10)[::2] + rank,'empty':np.zeros(0,dtype='f4')}
+        return mpi.allgather_values(values,mpicomm=mpicomm)
+
+    for toret in run_ranks(3,func):
+        for rank in range(3):
+            assert np.all(toret['array{:d}'.format(rank)] == np.arange(rank + 1.)) and toret['other{:d}'.format(rank)] == rank
+        # value of lowest rank is kept
+        assert np.all(toret['common'] == 0) and np.all(toret['strided'] == np.arange(10)[::2])
+        assert toret['empty'].dtype == np.dtype('f4') and toret['empty'].size == 0
+
+
+def patch_task_manager(monkeypatch):
+    """Make :class:`MPITaskManager` usable with :class:`ThreadComm`."""
+    # the stack of current communicators is shared by all threads
+    monkeypatch.setattr(mpi.CurrentMPIComm,'push',classmethod(lambda cls, mpicomm: None))
+    monkeypatch.setattr(mpi.CurrentMPIComm,'pop',classmethod(lambda cls: None))
+    monkeypatch.setattr(MPI,'Status',ThreadStatus)
+
+
+def run_task_manager(monkeypatch, size, tasks, **kwargs):
+    """Run :meth:`MPITaskManager.map` and :meth:`MPITaskManager.iterate` on ``size`` ranks; return results and tasks iterated by each rank."""
+    patch_task_manager(monkeypatch)
+
+    def func(mpicomm):
+        with mpi.MPITaskManager(mpicomm=mpicomm,**kwargs) as tm:
+            results = tm.map(lambda task: task**2,tasks)
+            own = list(tm.iterate(tasks)) if tm.mpicomm.rank == 0 else []
+            return results, own
+
+    return run_ranks(size,func)
+
+
+def test_schedules(monkeypatch):
+
+    tasks = list(range(11))
+    for schedule in mpi.MPITaskManager.schedules:
+        for chunksize in [1,3]:
+            toret = run_task_manager(monkeypatch,4,tasks,schedule=schedule,chunksize=chunksize)
+            for results,own in toret:
+                assert results == [task**2 for task in tasks]
+            # each task is computed once, by a worker
+            assert sorted(sum([own for results,own in toret],[])) == tasks
+            assert not toret[0][1]
+    # static schedule: contiguous blocks, one per worker
+    toret = run_task_manager(monkeypatch,4,tasks,schedule='static')
+    assert [own for results,own in toret] == [[],[0,1,2],[3,4,5,6],[7,8,9,10]]
+
+
+def test_work_on_root(monkeypatch):
+
+    tasks = list(range(11))
+    for schedule in mpi.MPITaskManager.schedules:
+        toret = run_task_manager(monkeypatch,4,tasks,schedule=schedule,work_on_root=True)
+        for results,own in toret:
+            assert results == [task**2 for task in tasks]
+        assert sorted(sum([own for results,own in toret],[])) == tasks
+    # static schedule: root gets the last block
+    assert [own for results,own in toret] == [[8,9,10],[0,1],[2,3,4],[5,6,7]]
+    with pytest.raises(ValueError):
+        mpi.MPITaskManager(nprocs_per_task=2,work_on_root=True,mpicomm=ThreadComm(ThreadWorld(4),0))
+
+
+def test_root_chunks(monkeypatch):
+
+    patch_task_manager(monkeypatch)
+    events = []
+    iprobe = ThreadComm.Iprobe
+
+    def Iprobe(self, *args, **kwargs):
+        if self.rank == 0: events.append(None)
+        return iprobe(self,*args,**kwargs)
+
+    monkeypatch.setattr(ThreadComm,'Iprobe',Iprobe)
+
+    def func(mpicomm):
+        with mpi.MPITaskManager(mpicomm=mpicomm,work_on_root=True,**kwargs) as tm:
+            for task in tm.iterate(tasks):
+                if tm.is_root(): events.append(task)
+
+    tasks = list(range(40))
+    for kwargs in [{'schedule':'guided'},{'schedule':'guided','chunksize':2},{'schedule':'dynamic','chunksize':3}]:
+        events.clear()
+        run_ranks(3,func)
+        # root computes at most chunksize tasks each time it checks for waiting workers
+        counts = [0]
+        for event in events:
+            if event is None: counts.append(0)
+            else: counts[-1] += 1
+        assert max(counts) <= kwargs.get('chunksize',1)
+
+
+if __name__ == '__main__':
+
+    setup_logging()
+    test_byte_counts()
+    test_allgather_values()
@@ -1,6 +1,10 @@
+import os
+import json
+import tempfile
+
 import numpy as np
 
-from pypescript.utils import setup_logging, BaseClass
+from pypescript.utils import setup_logging, BaseClass, Profiler
 from pypescript import syntax
 from pypescript.syntax import Decoder
 
@@ -39,15 +43,56 @@ def test_syntax():
     assert la(2) == (88,'hello')
 
 
+def test_datablock_keywords():
+    # options following $[section.name] entries must be kept
+    decoded = Decoder({'module':{'$[data.a]':'$[data.b]','$[data.c]':'$&[data.d]','$[data.e]':2,'option':1,'$iter':3}})
+    assert decoded.data == {'module':{'option':1,'$iter':3,syntax.datablock_duplicate:{'data.a':'data.b'},
+                            syntax.datablock_mapping:{'data.c':'data.d'},syntax.datablock_set:{'data.e':2}}}
+
+
 def test_repeat():
     decoded = Decoder('config3.yaml')
     assert decoded.data == {'hello': {'world': ['answer1', 'answer2', 'test%(2)'], 'other': 'test1'}, 'answer1': {'is': ['another1']},
                             'another1': {'is': '1'}, 'answer2': {'is': ['another2']}, 'another2': {'is': 2}, 'global1': 'test1'}
 
 
+def test_profiler():
+    profiler = Profiler()
+    for i in range(2):
+        with profiler('module','execute'):
+            np.ones(100000)
+    start = profiler.start()
+    profiler.stop(start,'module','execute',category='datablock_set')
+    assert profiler.stats['module','execute','step'][0] == 2
+    assert len(profiler.events) == 3
+    profiler = profiler.mpi_gather()
+    profiler.log_table()
+    assert profiler.to_list()[0]['category'] == 'step'
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        fn = os.path.join(tmp_dir,'profile.json')
+        profiler.save_json(fn)
+        with open(fn,'r') as file:
+            assert len(json.load(file)['stats']) == 2
+        fn = os.path.join(tmp_dir,'trace.json')
+        profiler.save_chrome_trace(fn)
+        with open(fn,'r') as file:
+            events = json.load(file)['traceEvents']
+            assert len(events) == 3 and events[0]['name'] == 'module.execute'
+    # only the most recent events are kept
+    profiler = Profiler(events=2)
+    for step in ['setup','execute','cleanup']:
+        with profiler('module',step):
+            pass
+    assert [event[1] for event in profiler.events] == ['execute','cleanup']
+    assert len(profiler.mpi_gather().events) == 2
+    assert Profiler(events=False).events is None
+
+
 if __name__ == '__main__':
 
     setup_logging()
     test_base_class()
     test_syntax()
+    test_datablock_keywords()
     test_repeat()
+    test_profiler()
@@ -3,8 +3,12 @@
 import os
 import sys
 import re
+import json
 import time
+import threading
 import functools
+import contextlib
+import collections
 import logging
 import traceback
 
@@ -214,6 +218,9 @@ class BaseTaskManager(metaclass=BaseMetaClass):
         if exc_value is not None:
             exception_handler(exc_type, exc_value, exc_traceback)
 
+    def free(self):
+        """Do nothing."""
+
     def iterate(self, tasks):
         """
         Iterate through a series of tasks.
@@ -642,3 +649,139 @@ class MemoryMonitor(object):
     def __exit__(self, exc_type, exc_value, exc_traceback):
         """Exit context."""
         self()
+
+
+class Profiler(metaclass=BaseMetaClass):
+    """
+    Class that records wall time, CPU time (of the current thread), number of calls and resident memory (RSS) increase
+    of code sections, identified by (module, step, category), e.g. module steps run by a pipeline (see :meth:`BasePipeline.set_profiler`).
+
+    >>> profiler = Profiler()
+    >>> with profiler('module','execute'):
+            '''do something'''
+    >>> profiler = profiler.mpi_gather() # sum over all ranks
+    >>> profiler.log_table()
+    >>> profiler.save_json('profile.json')
+    >>> profiler.save_chrome_trace('trace.json') # to be opened with chrome://tracing or https://ui.perfetto.dev
+
+    Attributes
+    ----------
+    stats : dict
+        Dictionary of (module, step, category): [number of calls, wall time, CPU time, RSS increase] (times in seconds, memory in bytes).
+
+    events : list, deque
+        List of (module, step, category, rank, thread, start time, wall time, CPU time, RSS increase), ``None`` if not recorded.
+    """
+
+    @mpi.CurrentMPIComm.enable
+    def __init__(self, events=True, mpicomm=None):
+        """
+        Initialize :class:`Profiler`.
+
+        Parameters
+        ----------
+        events : bool, int, default=True
+            Whether to keep each call in :attr:`events`, e.g. to export a Chrome trace.
+            If an integer, only the ``events`` most recent calls are kept, to bound memory in long runs.
+
+        mpicomm : MPI communicator, default=None
+            Communicator, defaults to current one.
+        """
+        self.stats = {}
+        if events is True:
+            self.events = []
+        elif events:
+            self.events = collections.deque(maxlen=events)
+        else:
+            self.events = None
+        self.mpicomm = mpicomm
+        self.nranks = 1
+        try:
+            import psutil
+            self._process = psutil.Process(os.getpid())
+        except ImportError:
+            self._process = None
+
+    def rss(self):
+        """Return resident memory (in bytes), 0 if :mod:`psutil` is not available."""
+        if self._process is None: return 0
+        return self._process.memory_info().rss
+
+    def start(self):
+        """Return start state, to be passed to :meth:`stop`."""
+        return (time.time(),time.perf_counter(),time.thread_time(),self.rss())
+
+    def stop(self, start, module, step, category='step'):
+        """Record section (``module``, ``step``, ``category``) started at ``start`` (returned by :meth:`start`)."""
+        wall, cpu, rss = time.perf_counter() - start[1], time.thread_time() - start[2], self.rss() - start[3]
+        stats = self.stats.setdefault((module,step,category),[0,0.,0.,0])
+        for ivalue,value in enumerate([1,wall,cpu,rss]): stats[ivalue] += value
+        if self.events is not None:
+            self.events.append((module,step,category,self.mpicomm.rank,threading.get_ident(),start[0],wall,cpu,rss))
+
+    @contextlib.contextmanager
+    def __call__(self, module, step, category='step'):
+        """Context manager recording section (``module``, ``step``, ``category``)."""
+        start = self.start()
+        try:
+            yield
+        finally:
+            self.stop(start,module,step,category=category)
+
+    def mpi_gather(self):
+        """
+        Return new :class:`Profiler` with :attr:`stats` summed and :attr:`events` of all ranks on rank 0
+        (empty on other ranks, such that :meth:`log_table`, :meth:`save_json` and :meth:`save_chrome_trace` can be called on all ranks).
+        """
+        states = self.mpicomm.gather((self.stats,self.events),root=0)
+        new = self.__class__(events=self.events is not None,mpicomm=self.mpicomm)
+        new.nranks = self.mpicomm.size
+        if self.mpicomm.rank != 0:
+            return new
+        for stats,events in states:
+            for key,value in stats.items():
+                stats_ = new.stats.setdefault(key,[0,0.,0.,0])
+                for ivalue,value_ in enumerate(value): stats_[ivalue] += value_
+            if new.events is not None: new.events += events
+        return new
+
+    def to_list(self):
+        """Return list of dictionaries with module, step, category, ncalls, wall, cpu and rss (see :attr:`stats`), sorted by decreasing wall time."""
+        toret = []
+        for (module,step,category),(ncalls,wall,cpu,rss) in self.stats.items():
+            toret.append({'module':module,'step':step,'category':category,'ncalls':ncalls,'wall':wall,'cpu':cpu,'rss':rss})
+        return sorted(toret,key=lambda row: -row['wall'])
+
+    def table(self):
+        """Return table (string) of :attr:`stats`, summed over ranks if :meth:`mpi_gather` was called."""
+        rows = [('module','step','category','ncalls','wall [s]','per call [ms]','cpu [s]','rss [MB]')]
+        for row in self.to_list():
+            rows.append((row['module'],row['step'],row['category'],'{:d}'.format(row['ncalls']),'{:.4f}'.format(row['wall']),
+                        '{:.4f}'.format(row['wall']/row['ncalls']*1e3),'{:.4f}'.format(row['cpu']),'{:.3f}'.format(row['rss']/1e6)))
+        widths = [max(len(row[icol]) for row in rows) for icol in range(len(rows[0]))]
+        return '\n'.join(' | '.join('{:<{}}'.format(value,width) for value,width in zip(row,widths)).rstrip() for row in rows)
+
+    def log_table(self):
+        """Log table of :attr:`stats` (see :meth:`table`)."""
+        for line in self.table().split('\n'):
+            self.log_info(line,rank=0)
+
+    @savefile
+    def save_json(self, filename):
+        """Save :attr:`stats` (see :meth:`to_list`) as a JSON file (on rank 0)."""
+        if self.mpicomm.rank == 0:
+            with open(filename,'w') as file:
+                json.dump({'nranks':self.nranks,'stats':self.to_list()},file,indent=2)
+
+    @savefile
+    def save_chrome_trace(self, filename):
+        """Save :attr:`events` in Chrome trace format (on rank 0), to be opened with chrome://tracing or https://ui.perfetto.dev; processes are MPI ranks."""
+        if self.events is None:
+            raise ValueError('Events are not recorded, create Profiler with events = True')
+        if self.mpicomm.rank == 0:
+            events = []
+            for module,step,category,rank,thread,start,wall,cpu,rss in self.events:
+                events.append({'name':'{}.{}'.format(module,step),'cat':category,'ph':'X','ts':start*1e6,'dur':wall*1e6,'pid':rank,'tid':thread,
+                               'args':{'cpu':cpu,'rss':rss}})
+            with open(filename,'w') as file:
+                json.dump({'traceEvents':events,'displayTimeUnit':'ms'},file)
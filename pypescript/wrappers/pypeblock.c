@@ -7,23 +7,26 @@
 #define MPICH_SKIP_MPICXX 1
 #define OMPI_SKIP_MPICXX  1
 
-#define GENERATE_GET_SCALAR(__name,__type,__conversion)\
-  int DataBlock_get_##__name##_default(DataBlock *data_block, const char * section, const char * name, __type * value, __type default_value)\
+// Bodies are shared between the (section, name) and the interned key (_k) variants,
+// __has, __get and __set being the corresponding DataBlock calls
+
+#define GENERATE_GET_SCALAR_DEFAULT_BODY(__type,__conversion,__has,__get)\
   {\
-    if (DataBlock_has_value(data_block, section, name) != 1) {\
+    if (__has != 1) {\
       *value = default_value;\
       return 1;\
     };\
-    PyObject * py_value = DataBlock_get_py_value(data_block, section, name, NULL);\
+    PyObject * py_value = __get;\
     if (py_value == NULL) return -1;\
     *value = (__type) __conversion;\
     Py_XDECREF(py_value);\
     if (PyErr_Occurred()) return -1;\
     return 0;\
   }\
-  int DataBlock_get_##__name(DataBlock *data_block, const char * section, const char * name, __type * value)\
+
+#define GENERATE_GET_SCALAR_BODY(__type,__conversion,__get)\
   {\
-    PyObject * py_value = DataBlock_get_py_value(data_block, section, name, NULL);\
+    PyObject * py_value = __get;\
     if (py_value == NULL) return -1;\
     *value = (__type) __conversion;\
     Py_XDECREF(py_value);\
@@ -31,28 +34,46 @@
     return 0;\
   }\
 
-#define GENERATE_SET_SCALAR(__name,__type,__conversion)\
-  int DataBlock_set_##__name(DataBlock *data_block, const char * section, const char * name, __type value)\
+#define GENERATE_GET_SCALAR(__name,__type,__conversion)\
+  int DataBlock_get_##__name##_default(DataBlock *data_block, const char * section, const char * name, __type * value, __type default_value)\
+  GENERATE_GET_SCALAR_DEFAULT_BODY(__type,__conversion,DataBlock_has_value(data_block, section, name),DataBlock_get_py_value(data_block, section, name, NULL))\
+  int DataBlock_get_##__name(DataBlock *data_block, const char * section, const char * name, __type * value)\
+  GENERATE_GET_SCALAR_BODY(__type,__conversion,DataBlock_get_py_value(data_block, section, name, NULL))\
+  int DataBlock_get_##__name##_default_k(DataBlock *data_block, DataBlock_key_t key, __type * value, __type default_value)\
+  GENERATE_GET_SCALAR_DEFAULT_BODY(__type,__conversion,DataBlock_has_value_k(data_block, key),DataBlock_get_py_value_k(data_block, key, NULL))\
+  int DataBlock_get_##__name##_k(DataBlock *data_block, DataBlock_key_t key, __type * value)\
+  GENERATE_GET_SCALAR_BODY(__type,__conversion,DataBlock_get_py_value_k(data_block, key, NULL))\
+
+#define GENERATE_SET_SCALAR_BODY(__conversion,__set)\
   {\
     PyObject * py_value = __conversion;\
-    int toret = DataBlock_set_py_value(data_block, section, name, py_value);\
+    if (py_value == NULL) return -1;\
+    int toret = __set;\
     Py_XDECREF(py_value);\
     return toret;\
   }\
 
-#define GENERATE_GET_ARRAY(__name,__type,__nptype)\
-  int DataBlock_get_##__name##_array(DataBlock *data_block, const char * section, const char * name, __type ** value, int * ndim, size_t ** shape)\
+#define GENERATE_SET_SCALAR(__name,__type,__conversion)\
+  int DataBlock_set_##__name(DataBlock *data_block, const char * section, const char * name, __type value)\
+  GENERATE_SET_SCALAR_BODY(__conversion,DataBlock_set_py_value(data_block, section, name, py_value))\
+  int DataBlock_set_##__name##_k(DataBlock *data_block, DataBlock_key_t key, __type value)\
+  GENERATE_SET_SCALAR_BODY(__conversion,DataBlock_set_py_value_k(data_block, key, py_value))\
+
+// __conversion counts and warns about an implicit conversion copy, see PyDataBlock_ArrayConversion
+#define GENERATE_GET_ARRAY_BODY(__type,__nptype,__get,__set,__conversion)\
   {\
     int toret = 0;\
     PyObject * py_value = NULL;\
     PyArrayObject * np_array = NULL;\
-    py_value = DataBlock_get_py_value(data_block, section, name, NULL);\
+    py_value = __get;\
     if (py_value == NULL) return -1;\
     np_array = (PyArrayObject *) PyArray_FROM_OTF(py_value, __nptype, NPY_ARRAY_INOUT_ARRAY2 | NPY_ARRAY_C_CONTIGUOUS);\
     if (np_array == NULL) goto except;\
-    if (PyArray_CHKFLAGS(np_array, NPY_ARRAY_WRITEBACKIFCOPY)) {\
-      PyArray_ResolveWritebackIfCopy(np_array);\
-      if (DataBlock_set_py_value(data_block, section, name, (PyObject *) np_array) != 0) goto except;\
+    if ((PyObject *) np_array != py_value) {\
+      /* Copy has the same content: no need to write it back, it replaces py_value in the DataBlock */\
+      if (PyArray_CHKFLAGS(np_array, NPY_ARRAY_WRITEBACKIFCOPY)) PyArray_DiscardWritebackIfCopy(np_array);\
+      if (__set != 0) goto except;\
+      if (__conversion != 0) goto except;\
     }\
     *ndim = PyArray_NDIM(np_array);\
     *shape = (size_t *) PyArray_SHAPE(np_array);\
@@ -66,19 +87,117 @@
     return toret;\
   }\
 
+#define GENERATE_GET_ARRAY(__name,__type,__nptype)\
+  int DataBlock_get_##__name##_array(DataBlock *data_block, const char * section, const char * name, __type ** value, int * ndim, size_t ** shape)\
+  GENERATE_GET_ARRAY_BODY(__type,__nptype,DataBlock_get_py_value(data_block, section, name, NULL),DataBlock_set_py_value(data_block, section, name, (PyObject *) np_array),\
+                          DataBlock_array_conversion(section, name, #__name))\
+  int DataBlock_get_##__name##_array_k(DataBlock *data_block, DataBlock_key_t key, __type ** value, int * ndim, size_t ** shape)\
+  GENERATE_GET_ARRAY_BODY(__type,__nptype,DataBlock_get_py_value_k(data_block, key, NULL),DataBlock_set_py_value_k(data_block, key, (PyObject *) np_array),\
+                          PyDataBlock_ArrayConversion(key, #__name))\
+
+#define GENERATE_DECLARE_ARRAY_BODY(__type,__nptype,__has,__get,__set,__conversion)\
+  {\
+    int toret = 0, idim = 0, match = 0;\
+    PyObject * py_value = NULL;\
+    PyArrayObject * np_array = NULL;\
+    if (__has == 1) {\
+      py_value = __get;\
+      if (py_value == NULL) return -1;\
+      match = PyArray_Check(py_value) && (PyArray_TYPE((PyArrayObject *) py_value) == __nptype) && (PyArray_NDIM((PyArrayObject *) py_value) == ndim)\
+              && PyArray_ISCARRAY((PyArrayObject *) py_value) && PyArray_ISNOTSWAPPED((PyArrayObject *) py_value);\
+      for (idim = 0; match && (idim < ndim); idim++) match = (PyArray_DIM((PyArrayObject *) py_value, idim) == (npy_intp) shape[idim]);\
+    }\
+    if (match) {\
+      np_array = (PyArrayObject *) py_value;\
+      py_value = NULL;\
+    }\
+    else {\
+      np_array = (PyArrayObject *) PyArray_ZEROS(ndim, (npy_intp *) shape, __nptype, 0);\
+      if (np_array == NULL) goto except;\
+      if (py_value != NULL) {\
+        if (PyArray_CopyObject(np_array, py_value) != 0) goto except;\
+        if (__conversion != 0) goto except;\
+      }\
+      if (__set != 0) goto except;\
+    }\
+    *value = (__type *) PyArray_DATA(np_array);\
+    goto finally;\
+  except:\
+    toret = -1;\
+  finally:\
+    Py_XDECREF(py_value);\
+    Py_XDECREF(np_array);\
+    return toret;\
+  }\
+
+#define GENERATE_DECLARE_ARRAY(__name,__type,__nptype)\
+  int DataBlock_declare_##__name##_array(DataBlock *data_block, const char * section, const char * name, __type ** value, int ndim, size_t * shape)\
+  GENERATE_DECLARE_ARRAY_BODY(__type,__nptype,DataBlock_has_value(data_block, section, name),DataBlock_get_py_value(data_block, section, name, NULL),\
+                              DataBlock_set_py_value(data_block, section, name, (PyObject *) np_array),DataBlock_array_conversion(section, name, #__name))\
+  int DataBlock_declare_##__name##_array_k(DataBlock *data_block, DataBlock_key_t key, __type ** value, int ndim, size_t * shape)\
+  GENERATE_DECLARE_ARRAY_BODY(__type,__nptype,DataBlock_has_value_k(data_block, key),DataBlock_get_py_value_k(data_block, key, NULL),\
+                              DataBlock_set_py_value_k(data_block, key, (PyObject *) np_array),PyDataBlock_ArrayConversion(key, #__name))\
+
+#define GENERATE_SET_ARRAY_BODY(__nptype,__set)\
+  {\
+    PyObject * py_value = NULL;\
+    py_value = DataBlock_buffer_array((void *) value, ndim, shape, __nptype, 0);\
+    if (py_value == NULL) return -1;\
+    int toret = __set;\
+    Py_XDECREF(py_value);\
+    return toret;\
+  }\
 
 #define GENERATE_SET_ARRAY(__name,__type,__nptype)\
   int DataBlock_set_##__name##_array(DataBlock *data_block, const char * section, const char * name, __type * value, int ndim, size_t * shape)\
+  GENERATE_SET_ARRAY_BODY(__nptype,DataBlock_set_py_value(data_block, section, name, py_value))\
+  int DataBlock_set_##__name##_array_k(DataBlock *data_block, DataBlock_key_t key, __type * value, int ndim, size_t * shape)\
+  GENERATE_SET_ARRAY_BODY(__nptype,DataBlock_set_py_value_k(data_block, key, py_value))\
+
+#define GENERATE_ALLOC_ARRAY_BODY(__type,__nptype,__has,__get,__set)\
   {\
+    int toret = 0, idim = 0, match = 0;\
+    size_t size = sizeof(__type);\
+    void * buffer = NULL;\
     PyObject * py_value = NULL;\
-    py_value = PyArray_SimpleNewFromData(ndim, (npy_intp *) shape, __nptype, (void *) value);\
-    PyArray_ENABLEFLAGS((PyArrayObject*) py_value, NPY_ARRAY_OWNDATA);\
-    if (py_value == NULL) return -1;\
-    int toret = DataBlock_set_py_value(data_block, section, name, py_value);\
+    for (idim = 0; idim < ndim; idim++) size *= shape[idim];\
+    if (__has == 1) {\
+      py_value = __get;\
+      if (py_value == NULL) return -1;\
+      /* Make sure the section is not shared with DataBlock copies: then the array is only used here if referenced by the DataBlock and py_value */\
+      if (__set != 0) goto except;\
+      match = (Py_REFCNT(py_value) == 2) && DataBlock_is_buffer_array(py_value, size) && (PyArray_TYPE((PyArrayObject *) py_value) == __nptype)\
+              && (PyArray_NDIM((PyArrayObject *) py_value) == ndim);\
+      for (idim = 0; match && (idim < ndim); idim++) match = (PyArray_DIM((PyArrayObject *) py_value, idim) == (npy_intp) shape[idim]);\
+    }\
+    if (!match) {\
+      Py_CLEAR(py_value);\
+      buffer = DataBlock_buffer_alloc(size);\
+      if (buffer == NULL) {\
+        PyErr_NoMemory();\
+        goto except;\
+      }\
+      py_value = DataBlock_buffer_array(buffer, ndim, shape, __nptype, size);\
+      if (py_value == NULL) goto except;\
+      if (__set != 0) goto except;\
+    }\
+    *value = (__type *) PyArray_DATA((PyArrayObject *) py_value);\
+    goto finally;\
+  except:\
+    toret = -1;\
+  finally:\
     Py_XDECREF(py_value);\
     return toret;\
   }\
 
+#define GENERATE_ALLOC_ARRAY(__name,__type,__nptype)\
+  int DataBlock_alloc_##__name##_array(DataBlock *data_block, const char * section, const char * name, __type ** value, int ndim, size_t * shape)\
+  GENERATE_ALLOC_ARRAY_BODY(__type,__nptype,DataBlock_has_value(data_block, section, name),DataBlock_get_py_value(data_block, section, name, NULL),\
+                            DataBlock_set_py_value(data_block, section, name, py_value))\
+  int DataBlock_alloc_##__name##_array_k(DataBlock *data_block, DataBlock_key_t key, __type ** value, int ndim, size_t * shape)\
+  GENERATE_ALLOC_ARRAY_BODY(__type,__nptype,DataBlock_has_value_k(data_block, key),DataBlock_get_py_value_k(data_block, key, NULL),\
+                            DataBlock_set_py_value_k(data_block, key, py_value))\
+
 
 __attribute__((constructor)) void init(void) {
   Py_Initialize();
@@ -93,6 +212,14 @@ void clear_errors(void) {
   PyErr_Clear();
 }
 
+DataBlock_gil_t DataBlock_acquire(void) {
+  return PyGILState_Ensure();
+}
+
+void DataBlock_release(DataBlock_gil_t state) {
+  PyGILState_Release(state);
+}
+
 int DataBlock_has_value(DataBlock *data_block, const char * section, const char * name)
 {
   PyObject *py_section = NULL, *py_name = NULL;
@@ -185,6 +312,153 @@ int DataBlock_move_value(DataBlock *data_block, const char * section1, const cha
   return toret;
 }
 
+static int DataBlock_array_conversion(const char * section, const char * name, const char * type)
+{
+  int toret = 0;
+  PyObject *key = Py_BuildValue("(ss)", section, name);
+  if (key == NULL) return -1;
+  toret = PyDataBlock_ArrayConversion(key, type);
+  Py_DECREF(key);
+  return toret;
+}
+
+// Buffers of arrays set (DataBlock_set_*_array) or allocated (DataBlock_alloc_*_array) by compiled modules
+// are owned by a capsule, base of the numpy array, which frees them when the array is deleted
+// Allocated buffers are rather returned to a small pool, to be reused by the next allocations of the same size
+// The pool holds at most DATABLOCK_BUFFER_POOL_SIZE buffers and DATABLOCK_BUFFER_POOL_BYTES bytes in total; other buffers are freed
+
+#define DATABLOCK_BUFFER_CAPSULE "pypescript.block.buffer"
+#define DATABLOCK_BUFFER_POOL_SIZE 16
+#define DATABLOCK_BUFFER_POOL_BYTES ((size_t) 64 << 20)
+
+static void * buffer_pool[DATABLOCK_BUFFER_POOL_SIZE];
+static size_t buffer_pool_sizes[DATABLOCK_BUFFER_POOL_SIZE];
+static int buffer_pool_count = 0;
+static size_t buffer_pool_bytes = 0;
+
+static void * DataBlock_buffer_alloc(size_t size)
+{
+  // Return buffer of size bytes, from the pool if possible
+  int ibuffer = 0;
+  void * toret = NULL;
+  for (ibuffer = buffer_pool_count - 1; ibuffer >= 0; ibuffer--) {
+    if (buffer_pool_sizes[ibuffer] == size) {
+      toret = buffer_pool[ibuffer];
+      buffer_pool_bytes -= size;
+      buffer_pool_count--;
+      buffer_pool[ibuffer] = buffer_pool[buffer_pool_count];
+      buffer_pool_sizes[ibuffer] = buffer_pool_sizes[buffer_pool_count];
+      return toret;
+    }
+  }
+  return malloc(size > 0 ? size : 1);
+}
+
+static void DataBlock_buffer_free(PyObject * capsule)
+{
+  // Capsule destructor; capsule context is the buffer size if it can be returned to the pool, else NULL
+  void * buffer = PyCapsule_GetPointer(capsule, DATABLOCK_BUFFER_CAPSULE);
+  size_t size = (size_t) PyCapsule_GetContext(capsule);
+  if (buffer == NULL) {
+    PyErr_Clear();
+    return;
+  }
+  if ((size > 0) && (buffer_pool_count < DATABLOCK_BUFFER_POOL_SIZE) && (size <= DATABLOCK_BUFFER_POOL_BYTES - buffer_pool_bytes)) {
+    buffer_pool[buffer_pool_count] = buffer;
+    buffer_pool_sizes[buffer_pool_count] = size;
+    buffer_pool_bytes += size;
+    buffer_pool_count++;
+    return;
+  }
+  free(buffer);
+}
+
+static PyObject * DataBlock_buffer_array(void * buffer, int ndim, size_t * shape, int nptype, size_t pool_size)
+{
+  // Return new numpy array on buffer, which is then owned by the array (returned to the pool when deleted if pool_size > 0)
+  PyObject * toret = NULL, * capsule = NULL;
+  capsule = PyCapsule_New(buffer, DATABLOCK_BUFFER_CAPSULE, DataBlock_buffer_free);
+  if (capsule == NULL) {
+    free(buffer);
+    return NULL;
+  }
+  if ((pool_size > 0) && (PyCapsule_SetContext(capsule, (void *) pool_size) != 0)) goto except;
+  toret = PyArray_SimpleNewFromData(ndim, (npy_intp *) shape, nptype, buffer);
+  if (toret == NULL) goto except;
+  // Steals the capsule reference, even on failure
+  if (PyArray_SetBaseObject((PyArrayObject *) toret, capsule) != 0) {
+    capsule = NULL;
+    goto except;
+  }
+  return toret;
+except:
+  Py_XDECREF(capsule);
+  Py_XDECREF(toret);
+  return NULL;
+}
+
+static int DataBlock_is_buffer_array(PyObject * py_value, size_t size)
+{
+  // Return 1 if py_value is an array on a whole buffer of size bytes, from DataBlock_alloc_*_array
+  PyObject * base = NULL;
+  if (!PyArray_Check(py_value)) return 0;
+  base = PyArray_BASE((PyArrayObject *) py_value);
+  return (base != NULL) && PyCapsule_IsValid(base, DATABLOCK_BUFFER_CAPSULE) && ((size_t) PyCapsule_GetContext(base) == size)
+         && (PyCapsule_GetPointer(base, DATABLOCK_BUFFER_CAPSULE) == PyArray_DATA((PyArrayObject *) py_value));
+}
+
+// Interned keys
+
+DataBlock_key_t DataBlock_intern_key(const char * section, const char * name)
+{
+  return PyDataBlock_InternKey(section, name);
+}
+
+void DataBlock_free_key(DataBlock_key_t key)
+{
+  Py_XDECREF(key);
+}
+
+int DataBlock_has_value_k(DataBlock *data_block, DataBlock_key_t key)
+{
+  return PyDataBlock_HasValueKey(data_block, key) == 1;
+}
+
+int DataBlock_del_value_k(DataBlock *data_block, DataBlock_key_t key)
+{
+  return PyDataBlock_DelValueKey(data_block, key);
+}
+
+int DataBlock_set_py_value_k(DataBlock *data_block, DataBlock_key_t key, PyObject * py_value)
+{
+  if (PyDataBlock_SetValueKey(data_block, key, py_value) != 0) return -1;
+  return 0;
+}
+
+PyObject * DataBlock_get_py_value_k(DataBlock *data_block, DataBlock_key_t key, PyObject * default_value)
+{
+  return PyDataBlock_GetValueKey(data_block, key, default_value);
+}
+
+int DataBlock_duplicate_value_k(DataBlock *data_block, DataBlock_key_t key1, DataBlock_key_t key2)
+{
+  PyObject *py_value = DataBlock_get_py_value_k(data_block, key1, NULL);
+  if (py_value == NULL) return 0;
+  int toret = DataBlock_set_py_value_k(data_block, key2, py_value);
+  Py_DECREF(py_value);
+  return toret;
+}
+
+int DataBlock_move_value_k(DataBlock *data_block, DataBlock_key_t key1, DataBlock_key_t key2)
+{
+  PyObject *py_value = DataBlock_get_py_value_k(data_block, key1, NULL);
+  if (py_value == NULL) return 0;
+  DataBlock_del_value_k(data_block, key1);
+  int toret = DataBlock_set_py_value_k(data_block, key2, py_value);
+  Py_DECREF(py_value);
+  return toret;
+}
+
 // Scalar getters
 
 GENERATE_GET_SCALAR(capsule,void *,PyCapsule_GetPointer(py_value, NULL))
@@ -237,6 +511,26 @@ GENERATE_SET_ARRAY(double,double,NPY_DOUBLE)
 
 GENERATE_SET_ARRAY(string,char *,NPY_STRING)
 
+// Array allocators
+
+GENERATE_ALLOC_ARRAY(int,int,NPY_INT)
+
+GENERATE_ALLOC_ARRAY(long,long,NPY_LONG)
+
+GENERATE_ALLOC_ARRAY(float,float,NPY_FLOAT)
+
+GENERATE_ALLOC_ARRAY(double,double,NPY_DOUBLE)
+
+// Typed array slots
+
+GENERATE_DECLARE_ARRAY(int,int,NPY_INT)
+
+GENERATE_DECLARE_ARRAY(long,long,NPY_LONG)
+
+GENERATE_DECLARE_ARRAY(float,float,NPY_FLOAT)
+
+GENERATE_DECLARE_ARRAY(double,double,NPY_DOUBLE)
+
 /*
 int DataBlock_get_mpi_comm(DataBlock *data_block, const char * section, const char * name, MPI_Comm * value)
 {
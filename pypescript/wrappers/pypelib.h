@@ -13,6 +13,12 @@ extern "C" {
 
 typedef PyDataBlock DataBlock;
 
+// Handle to a (section, name) pair of interned, pre-hashed strings, see DataBlock_intern_key
+typedef PyObject * DataBlock_key_t;
+
+// State returned by DataBlock_acquire, to be passed to DataBlock_release
+typedef PyGILState_STATE DataBlock_gil_t;
+
 extern const char * MODULE_NAME;
 
 extern int setup(const char * name, DataBlock *config_block, DataBlock *data_block);
@@ -24,6 +30,14 @@ extern int cleanup(const char * name, DataBlock *config_block, DataBlock *data_b
 
 void clear_errors(void);
 
+// Modules compiled with release_gil: true run setup/execute/cleanup without holding the Python GIL.
+// DataBlock accessors must then be called between DataBlock_acquire() and DataBlock_release(state), e.g.
+// DataBlock_gil_t state = DataBlock_acquire(); DataBlock_get_double(...); DataBlock_release(state);
+// These calls can be nested, and are no-ops (but cheap) if the GIL is held already. Loggers acquire the GIL themselves.
+DataBlock_gil_t DataBlock_acquire(void);
+
+void DataBlock_release(DataBlock_gil_t state);
+
 int log_info(const char * name, const char * format, ...);
 
 int log_warning(const char * name, const char * format, ...);
@@ -32,6 +46,10 @@ int log_debug(const char * name, const char * format, ...);
 
 int log_error(const char * name, const char * format, ...);
 
+// Return 1 if logger name is enabled for level type ("debug", "info", "warning" or "error"), 0 if not, -1 on error
+// Loggers are cached and messages of disabled levels are not formatted; use this to skip building expensive messages
+int log_is_enabled(const char * name, const char * type);
+
 
 // DataBlock stuffs
 // Bool tests
@@ -112,6 +130,137 @@ int DataBlock_set_float_array(DataBlock *data_block, const char * section, const
 
 int DataBlock_set_double_array(DataBlock *data_block, const char * section, const char * name, double * value, int ndim, size_t * shape);
 
+// Array allocators
+// Return in value a buffer for a new array of the given type and shape, set in (section, name). The buffer content is undefined.
+// If (section, name) already holds an array allocated this way, of the same type and shape, and not referenced anywhere else,
+// its buffer is reused. Otherwise, buffers are taken from a pool of buffers of deleted arrays, or allocated.
+
+int DataBlock_alloc_int_array(DataBlock *data_block, const char * section, const char * name, int ** value, int ndim, size_t * shape);
+
+int DataBlock_alloc_long_array(DataBlock *data_block, const char * section, const char * name, long ** value, int ndim, size_t * shape);
+
+int DataBlock_alloc_float_array(DataBlock *data_block, const char * section, const char * name, float ** value, int ndim, size_t * shape);
+
+int DataBlock_alloc_double_array(DataBlock *data_block, const char * section, const char * name, double ** value, int ndim, size_t * shape);
+
+// Typed array slots
+// Make sure (section, name) holds an aligned, C-contiguous array of the given type and shape, and return its buffer in value.
+// If the current value does not match, it is replaced by such an array, with the current value copied in (counted as a conversion, see
+// pypescript.block.array_conversions) or zeros. The buffer can be kept across calls, as long as (section, name) is not set to another value.
+
+int DataBlock_declare_int_array(DataBlock *data_block, const char * section, const char * name, int ** value, int ndim, size_t * shape);
+
+int DataBlock_declare_long_array(DataBlock *data_block, const char * section, const char * name, long ** value, int ndim, size_t * shape);
+
+int DataBlock_declare_float_array(DataBlock *data_block, const char * section, const char * name, float ** value, int ndim, size_t * shape);
+
+int DataBlock_declare_double_array(DataBlock *data_block, const char * section, const char * name, double ** value, int ndim, size_t * shape);
+
+
+// Same as above, with interned keys instead of (section, name) strings
+
+DataBlock_key_t DataBlock_intern_key(const char * section, const char * name);
+
+void DataBlock_free_key(DataBlock_key_t key);
+
+// Bool tests
+
+int DataBlock_has_value_k(DataBlock *data_block, DataBlock_key_t key);
+
+int DataBlock_del_value_k(DataBlock *data_block, DataBlock_key_t key);
+
+PyObject * DataBlock_get_py_value_k(DataBlock *data_block, DataBlock_key_t key, PyObject * default_value);
+
+int DataBlock_set_py_value_k(DataBlock *data_block, DataBlock_key_t key, PyObject * py_value);
+
+int DataBlock_duplicate_value_k(DataBlock *data_block, DataBlock_key_t key1, DataBlock_key_t key2);
+
+int DataBlock_move_value_k(DataBlock *data_block, DataBlock_key_t key1, DataBlock_key_t key2);
+
+// Scalar getters
+
+int DataBlock_get_capsule_default_k(DataBlock *data_block, DataBlock_key_t key, void ** value, void * default_value);
+
+int DataBlock_get_capsule_k(DataBlock *data_block, DataBlock_key_t key, void ** value);
+
+int DataBlock_get_mpi_comm_default_k(DataBlock *data_block, DataBlock_key_t key, MPI_Comm * value, MPI_Comm default_value);
+
+int DataBlock_get_mpi_comm_k(DataBlock *data_block, DataBlock_key_t key, MPI_Comm * value);
+
+int DataBlock_get_int_default_k(DataBlock *data_block, DataBlock_key_t key, int * value, int default_value);
+
+int DataBlock_get_int_k(DataBlock *data_block, DataBlock_key_t key, int * value);
+
+int DataBlock_get_long_default_k(DataBlock *data_block, DataBlock_key_t key, long * value, long default_value);
+
+int DataBlock_get_long_k(DataBlock *data_block, DataBlock_key_t key, long * value);
+
+int DataBlock_get_float_default_k(DataBlock *data_block, DataBlock_key_t key, float * value, float default_value);
+
+int DataBlock_get_float_k(DataBlock *data_block, DataBlock_key_t key, float * value);
+
+int DataBlock_get_double_default_k(DataBlock *data_block, DataBlock_key_t key, double * value, double default_value);
+
+int DataBlock_get_double_k(DataBlock *data_block, DataBlock_key_t key, double * value);
+
+int DataBlock_get_string_default_k(DataBlock *data_block, DataBlock_key_t key, char ** value, char * default_value);
+
+int DataBlock_get_string_k(DataBlock *data_block, DataBlock_key_t key, char ** value);
+
+// Scalar setters
+
+int DataBlock_set_capsule_k(DataBlock *data_block, DataBlock_key_t key, void * value);
+
+int DataBlock_set_int_k(DataBlock *data_block, DataBlock_key_t key, int value);
+
+int DataBlock_set_long_k(DataBlock *data_block, DataBlock_key_t key, long value);
+
+int DataBlock_set_float_k(DataBlock *data_block, DataBlock_key_t key, float value);
+
+int DataBlock_set_double_k(DataBlock *data_block, DataBlock_key_t key, double value);
+
+int DataBlock_set_string_k(DataBlock *data_block, DataBlock_key_t key, char * value);
+
+// Array getters
+
+int DataBlock_get_int_array_k(DataBlock *data_block, DataBlock_key_t key, int ** value, int * ndim, size_t ** shape);
+
+int DataBlock_get_long_array_k(DataBlock *data_block, DataBlock_key_t key, long ** value, int * ndim, size_t ** shape);
+
+int DataBlock_get_float_array_k(DataBlock *data_block, DataBlock_key_t key, float ** value, int * ndim, size_t ** shape);
+
+int DataBlock_get_double_array_k(DataBlock *data_block, DataBlock_key_t key, double ** value, int * ndim, size_t ** shape);
+
+// Array setters
+
+int DataBlock_set_int_array_k(DataBlock *data_block, DataBlock_key_t key, int * value, int ndim, size_t * shape);
+
+int DataBlock_set_long_array_k(DataBlock *data_block, DataBlock_key_t key, long * value, int ndim, size_t * shape);
+
+int DataBlock_set_float_array_k(DataBlock *data_block, DataBlock_key_t key, float * value, int ndim, size_t * shape);
+
+int DataBlock_set_double_array_k(DataBlock *data_block, DataBlock_key_t key, double * value, int ndim, size_t * shape);
+
+// Array allocators
+
+int DataBlock_alloc_int_array_k(DataBlock *data_block, DataBlock_key_t key, int ** value, int ndim, size_t * shape);
+
+int DataBlock_alloc_long_array_k(DataBlock *data_block, DataBlock_key_t key, long ** value, int ndim, size_t * shape);
+
+int DataBlock_alloc_float_array_k(DataBlock *data_block, DataBlock_key_t key, float ** value, int ndim, size_t * shape);
+
+int DataBlock_alloc_double_array_k(DataBlock *data_block, DataBlock_key_t key, double ** value, int ndim, size_t * shape);
+
+// Typed array slots
+
+int DataBlock_declare_int_array_k(DataBlock *data_block, DataBlock_key_t key, int ** value, int ndim, size_t * shape);
+
+int DataBlock_declare_long_array_k(DataBlock *data_block, DataBlock_key_t key, long ** value, int ndim, size_t * shape);
+
+int DataBlock_declare_float_array_k(DataBlock *data_block, DataBlock_key_t key, float ** value, int ndim, size_t * shape);
+
+int DataBlock_declare_double_array_k(DataBlock *data_block, DataBlock_key_t key, double ** value, int ndim, size_t * shape);
+
 
 #ifdef __cplusplus
 }
@@ -1,6 +1,7 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 #include <stdarg.h>
+#include <string.h>
 #include "pypelib.h"
 
 #define STRINGIFY(A) #A
@@ -10,7 +11,9 @@
   {\
     va_list vargs;\
     va_start (vargs,format);\
-    return log_msg(STRINGIFY(__name), name, format, vargs);\
+    int toret = log_msg(STRINGIFY(__name), name, format, vargs);\
+    va_end (vargs);\
+    return toret;\
   }\
 
 /***********************************************************/
@@ -18,36 +21,104 @@
 /* by H.Dickten 2014                                       */
 /***********************************************************/
 
-int log_msg(const char * type, const char * name, const char * format, va_list vargs)
+// Cache of {name: logging.Logger}, so that logging is not imported and getLogger not called at each log call
+static PyObject *loggers = NULL;
+
+static PyObject * log_get_logger(const char * name)
 {
-  PyObject *logging = NULL, *logger = NULL, *py_name = NULL, *string = NULL;
-  char * cstring;
-  int toret = 0;
+  // Return borrowed reference to logger name, NULL on error
+  PyObject *logging = NULL, *logger = NULL;
+
+  if (loggers == NULL) {
+    loggers = PyDict_New();
+    if (loggers == NULL) return NULL;
+  }
+  logger = PyDict_GetItemString(loggers, name);
+  if (logger != NULL) return logger;
 
-  if (vasprintf(&cstring, format, vargs) < 0) goto except;
   // import logging module on demand
   logging = PyImport_ImportModule("logging");
-  if (logging == NULL) goto except; // raises error
+  if (logging == NULL) return NULL; // raises error
+  logger = PyObject_CallMethod(logging, "getLogger", "s", name);
+  Py_DECREF(logging);
+  if (logger == NULL) return NULL; // raises error
+  if (PyDict_SetItemString(loggers, name, logger) < 0) {
+    Py_DECREF(logger);
+    return NULL;
+  }
+  Py_DECREF(logger); // loggers holds the reference
+  return logger;
+}
+
+static int log_level(const char * type)
+{
+  // Return Python logging level corresponding to type, -1 on error
+  if (strcmp(type, "debug") == 0) return 10;
+  if (strcmp(type, "info") == 0) return 20;
+  if (strcmp(type, "warning") == 0) return 30;
+  if (strcmp(type, "error") == 0) return 40;
+  PyErr_Format(PyExc_ValueError, "Unknown logging level %s", type);
+  return -1;
+}
+
+static int _log_is_enabled(const char * name, const char * type)
+{
+  // Same as log_is_enabled, GIL must be held
+  PyObject *logger = NULL, *enabled = NULL;
+  int level = log_level(type);
+  if (level < 0) return -1;
+
+  logger = log_get_logger(name);
+  if (logger == NULL) return -1;
+  enabled = PyObject_CallMethod(logger, "isEnabledFor", "i", level);
+  if (enabled == NULL) return -1; // raises error
+  int toret = PyObject_IsTrue(enabled);
+  Py_DECREF(enabled);
+  return toret;
+}
+
+int log_is_enabled(const char * name, const char * type)
+{
+  // may be called from modules compiled with release_gil
+  PyGILState_STATE state = PyGILState_Ensure();
+  int toret = _log_is_enabled(name, type);
+  PyGILState_Release(state);
+  return toret;
+}
+
+int log_msg(const char * type, const char * name, const char * format, va_list vargs)
+{
+  PyObject *logger = NULL, *string = NULL, *result = NULL;
+  char * cstring = NULL;
+  int toret = 0;
+  // may be called from modules compiled with release_gil
+  PyGILState_STATE state = PyGILState_Ensure();
 
-  py_name = PyUnicode_FromString(name);
-  if (py_name == NULL) goto except;
+  // do not format the message if it is not to be logged
+  int enabled = _log_is_enabled(name, type);
+  if (enabled < 0) goto except;
+  if (!enabled) goto finally;
+  logger = log_get_logger(name); // borrowed
 
-  logger = PyObject_CallMethod(logging, "getLogger", "O", py_name);
-  if (logger == NULL) goto except; // raises error
+  if (vasprintf(&cstring, format, vargs) < 0) {
+    cstring = NULL;
+    PyErr_NoMemory();
+    goto except;
+  }
   // build msg-string
   string = PyUnicode_FromString(cstring);
   if (string == NULL) goto except;
 
-  if (PyObject_CallMethod(logger, type, "O", string) == NULL) goto except;  // raises error
+  result = PyObject_CallMethod(logger, type, "O", string);
+  if (result == NULL) goto except;  // raises error
   goto finally;
 except:
   toret = -1;
 finally:
+  Py_XDECREF(result);
   Py_XDECREF(string);
-  Py_XDECREF(logger);
-  Py_XDECREF(py_name);
-  Py_XDECREF(logging);
   free(cstring);
+  PyGILState_Release(state);
   return toret;
 }
 
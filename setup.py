@@ -20,6 +20,6 @@ setup(name='pypescript',
     ext_modules=[extension],
     package_data={base_dir:['wrappers/*','block/*']},
     install_requires=['pyyaml','numpy','mpi4py'],
-    extras_require={'extras':['pytest','psutil']},
+    extras_require={'extras':['pytest','pytest-benchmark','psutil']},
     entry_points={'console_scripts': ['pypescript=pypescript.__main__:main','pypescript_section_names=pypescript.setuppype.generate_section_names:main']}
     )
@@ -80,9 +80,9 @@ class JointGaussianLikelihood(GaussianLikelihood):
         for module in self.join:
             module.set_data_block(self.pipe_block)
             module.setup()
-            for key in self.pipe_block.keys(section=section_names.data):
+            for key,value in self.pipe_block.items(section=section_names.data):
                 if key not in join: join[key] = []
-                join[key].append(self.pipe_block[key])
+                join[key].append(value)
         for key in join:
             self.data_block[key] = self.pipe_block[key] = np.concatenate(join[key])
         for todo in self.setup_todos:
@@ -96,9 +96,9 @@ class JointGaussianLikelihood(GaussianLikelihood):
         for module in self.join:
             module.set_data_block(self.pipe_block)
             module.execute()
-            for key in self.pipe_block.keys(section=section_names.model):
+            for key,value in self.pipe_block.items(section=section_names.model):
                 if key not in join: join[key] = []
-                join[key].append(self.pipe_block[key])
+                join[key].append(value)
         for key in join:
             self.data_block[key] = self.pipe_block[key] = np.concatenate(join[key])
         for todo in self.execute_todos:
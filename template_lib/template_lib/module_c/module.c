@@ -29,6 +29,10 @@ typedef struct {
   float x;
 } TestStruct;
 
+// Interned keys: (section, name) strings are converted and hashed once, in setup, then reused at each execute
+static DataBlock_key_t double_key = NULL;
+static DataBlock_key_t double_array_key = NULL;
+
 int setup(const char * name, DataBlock *config_block, DataBlock *data_block) {
   // Set up module (called at the beginning)
   // In the following we are doing stupid things as an example
@@ -50,6 +54,11 @@ int setup(const char * name, DataBlock *config_block, DataBlock *data_block) {
   pname[len] = 0;
   status = log_info(MODULE_NAME, "Hello, world! I am process %d of %d on %s.", rank, size, pname);
 
+  if (double_key == NULL) double_key = DataBlock_intern_key(PARAMETERS_SECTION, "double");
+  if (double_key == NULL) goto except;
+  if (double_array_key == NULL) double_array_key = DataBlock_intern_key(PARAMETERS_SECTION, "double_array");
+  if (double_array_key == NULL) goto except;
+
   if (DataBlock_get_int_default(config_block, name, "answer", &answer, ANSWER) < 0) goto except;
   if (answer != ANSWER) goto except;
   if (DataBlock_get_long_default(config_block, name, "answer", &long_answer, ANSWER) < 0) goto except;
@@ -61,7 +70,7 @@ int setup(const char * name, DataBlock *config_block, DataBlock *data_block) {
   if (DataBlock_set_int(data_block, PARAMETERS_SECTION, "int", ANSWER) != 0) goto except;
   if (DataBlock_set_long(data_block, PARAMETERS_SECTION, "long", ANSWER) != 0) goto except;
   if (DataBlock_set_float(data_block, PARAMETERS_SECTION, "float", ANSWER) != 0) goto except;
-  if (DataBlock_set_double(data_block, PARAMETERS_SECTION, "double", ANSWER) != 0) goto except;
+  if (DataBlock_set_double_k(data_block, double_key, ANSWER) != 0) goto except;
 
   // Note that DataBlock_set_string creates a copy of the passed value: you should free it if necessary, for example:
   char * string_scalar = (char *) malloc(sizeof(char)*10);
@@ -76,8 +85,6 @@ int setup(const char * name, DataBlock *config_block, DataBlock *data_block) {
   for (size_t i=0;i<ASIZE;i++) long_array[i] = (long) answer;
   float *float_array = (float *) malloc(sizeof(float)*ASIZE);
   for (size_t i=0;i<ASIZE;i++) float_array[i] = (float) answer;
-  double *double_array = (double *) malloc(sizeof(double)*ASIZE);
-  for (size_t i=0;i<ASIZE;i++) double_array[i] = (double) answer;
   // DataBlock_set_xxx_array steals the reference, i.e. it takes full responsibility of the array it receives
   // Hence these arrays should not be freed
   // Hence NEVER do DataBlock_set_xxx_array with an array (and shape) coming from DataBlock_get_xxx_array:
@@ -86,7 +93,11 @@ int setup(const char * name, DataBlock *config_block, DataBlock *data_block) {
   if (DataBlock_set_int_array(data_block, PARAMETERS_SECTION, "int_array", int_array, ndim, shape) != 0) goto except;
   if (DataBlock_set_long_array(data_block, PARAMETERS_SECTION, "long_array", long_array, ndim, shape) != 0) goto except;
   if (DataBlock_set_float_array(data_block, PARAMETERS_SECTION, "float_array", float_array, ndim, shape) != 0) goto except;
-  if (DataBlock_set_double_array(data_block, PARAMETERS_SECTION, "double_array", double_array, ndim, shape) != 0) goto except;
+  // DataBlock_alloc_xxx_array allocates the array in the data block (reusing its buffer if it is not referenced elsewhere)
+  // and returns a pointer to it, to be filled in place
+  double *double_array = NULL;
+  if (DataBlock_alloc_double_array_k(data_block, double_array_key, &double_array, ndim, shape) != 0) goto except;
+  for (size_t i=0;i<ASIZE;i++) double_array[i] = (double) answer;
 
   TestStruct* s = (TestStruct*) malloc(sizeof(TestStruct));
   s->n = 42;
@@ -149,7 +160,7 @@ int execute(const char * name, DataBlock *config_block, DataBlock *data_block) {
   status = log_info(MODULE_NAME, "long is %ld.", long_scalar);
   if (DataBlock_get_float(data_block, PARAMETERS_SECTION, "float", &float_scalar) < 0) goto except;
   status = log_info(MODULE_NAME, "float is %.3f.", float_scalar);
-  if (DataBlock_get_double(data_block, PARAMETERS_SECTION, "double", &double_scalar) < 0) goto except;
+  if (DataBlock_get_double_k(data_block, double_key, &double_scalar) < 0) goto except;
   status = log_info(MODULE_NAME, "double is %.3f.", double_scalar);
   if (DataBlock_get_string(data_block, PARAMETERS_SECTION, "string", &string_scalar) < 0) goto except;
   status = log_info(MODULE_NAME, "string is %s.", string_scalar);
@@ -159,7 +170,7 @@ int execute(const char * name, DataBlock *config_block, DataBlock *data_block) {
   if ((ndim != NDIM) || (shape[0] != ASIZE) || !alllong(long_array,answer,ASIZE)) goto except;
   if (DataBlock_get_float_array(data_block, PARAMETERS_SECTION, "float_array", &float_array, &ndim, &shape) < 0) goto except;
   if ((ndim != NDIM) || (shape[0] != ASIZE) || !allfloat(float_array,(float) answer,ASIZE)) goto except;
-  if (DataBlock_get_double_array(data_block, PARAMETERS_SECTION, "double_array", &double_array, &ndim, &shape) < 0) goto except;
+  if (DataBlock_get_double_array_k(data_block, double_array_key, &double_array, &ndim, &shape) < 0) goto except;
   if ((ndim != NDIM) || (shape[0] != ASIZE) || !alldouble(double_array,(double) answer,ASIZE)) goto except;
   // In place operations, values in DataBlock updated automatically
   for (size_t i=0;i<shape[0];i++)
@@ -186,6 +197,11 @@ int execute(const char * name, DataBlock *config_block, DataBlock *data_block) {
   status = log_info(MODULE_NAME, "External float array dimensions are %d, shape is (%d, ...).", ndim, shape[0]);
   for (size_t i=0;i<shape[0];i++) int_array[i] += 1;
   for (size_t i=0;i<shape[0];i++) float_array[i] += 1;
+  // DataBlock_declare_xxx_array makes sure the value is a C-contiguous array of the given type and shape (copying it otherwise,
+  // or creating it zero-filled if missing) and returns a pointer to it, valid as long as the value is not replaced
+  size_t declared_shape[1] = {ASIZE};
+  if (DataBlock_declare_double_array(data_block, "external", "declared_array", &double_array, NDIM, declared_shape) < 0) goto except;
+  for (size_t i=0;i<ASIZE;i++) double_array[i] += 1;
   TestStruct* s;
   if (DataBlock_get_capsule(config_block, name, "capsule", &s) != 0) goto except;
   if ((s->n != 42) || (s->x != 42.0)) goto except;
@@ -203,6 +219,10 @@ int cleanup(const char * name, DataBlock *config_block, DataBlock *data_block) {
   void* s;
   if (DataBlock_get_capsule(config_block, name, "capsule", &s) != 0) goto except;
   free(s);
+  DataBlock_free_key(double_key);
+  double_key = NULL;
+  DataBlock_free_key(double_array_key);
+  double_array_key = NULL;
   goto finally;
 except:
   status = -1;
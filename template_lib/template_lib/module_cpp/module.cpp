@@ -27,6 +27,10 @@ extern "C" {
 
 const char * MODULE_NAME = "CPPModule";
 
+// Interned keys: (section, name) strings are converted and hashed once, in setup, then reused at each execute
+static DataBlock_key_t double_key = NULL;
+static DataBlock_key_t double_array_key = NULL;
+
 
 int setup(const char * name, DataBlock *config_block, DataBlock *data_block) {
   // Set up module (called at the beginning)
@@ -49,6 +53,11 @@ int setup(const char * name, DataBlock *config_block, DataBlock *data_block) {
   pname[len] = 0;
   status = log_info(MODULE_NAME, "Hello, world! I am process %d of %d on %s.", rank, size, pname);
 
+  if (double_key == NULL) double_key = DataBlock_intern_key(PARAMETERS_SECTION, "double");
+  if (double_key == NULL) return -1;
+  if (double_array_key == NULL) double_array_key = DataBlock_intern_key(PARAMETERS_SECTION, "double_array");
+  if (double_array_key == NULL) return -1;
+
   if (DataBlock_get_int_default(config_block, name, "answer", &answer, ANSWER) < 0) return -1;
   if (answer != ANSWER) return -1;
   if (DataBlock_get_long_default(config_block, name, "answer", &long_answer, ANSWER) < 0) return -1;
@@ -60,7 +69,7 @@ int setup(const char * name, DataBlock *config_block, DataBlock *data_block) {
   if (DataBlock_set_int(data_block, PARAMETERS_SECTION, "int", ANSWER) != 0) return -1;
   if (DataBlock_set_long(data_block, PARAMETERS_SECTION, "long", ANSWER) != 0) return -1;
   if (DataBlock_set_float(data_block, PARAMETERS_SECTION, "float", ANSWER) != 0) return -1;
-  if (DataBlock_set_double(data_block, PARAMETERS_SECTION, "double", ANSWER) != 0) return -1;
+  if (DataBlock_set_double_k(data_block, double_key, ANSWER) != 0) return -1;
   // Note that DataBlock_set_string creates a copy of the passed value: you should free it if necessary, for example:
   char * string_scalar = (char *) malloc(sizeof(char)*10);
   sprintf(string_scalar,"string");
@@ -74,8 +83,6 @@ int setup(const char * name, DataBlock *config_block, DataBlock *data_block) {
   for (size_t i=0;i<ASIZE;i++) long_array[i] = (long) answer;
   float *float_array = (float *) malloc(sizeof(float)*ASIZE);
   for (size_t i=0;i<ASIZE;i++) float_array[i] = (float) answer;
-  double *double_array = (double *) malloc(sizeof(double)*ASIZE);
-  for (size_t i=0;i<ASIZE;i++) double_array[i] = (double) answer;
   // DataBlock_set_xxx_array steals the reference, i.e. it takes full responsibility of the array it receives
   // Hence these arrays should not be freed
   // Hence NEVER do DataBlock_set_xxx_array with an array (and shape) coming from DataBlock_get_xxx_array:
@@ -84,7 +91,11 @@ int setup(const char * name, DataBlock *config_block, DataBlock *data_block) {
   if (DataBlock_set_int_array(data_block, PARAMETERS_SECTION, "int_array", int_array, ndim, shape) != 0) return -1;
   if (DataBlock_set_long_array(data_block, PARAMETERS_SECTION, "long_array", long_array, ndim, shape) != 0) return -1;
   if (DataBlock_set_float_array(data_block, PARAMETERS_SECTION, "float_array", float_array, ndim, shape) != 0) return -1;
-  if (DataBlock_set_double_array(data_block, PARAMETERS_SECTION, "double_array", double_array, ndim, shape) != 0) return -1;
+  // DataBlock_alloc_xxx_array allocates the array in the data block (reusing its buffer if it is not referenced elsewhere)
+  // and returns a pointer to it, to be filled in place
+  double *double_array = NULL;
+  if (DataBlock_alloc_double_array_k(data_block, double_array_key, &double_array, ndim, shape) != 0) return -1;
+  for (size_t i=0;i<ASIZE;i++) double_array[i] = (double) answer;
   return status;
 }
 
@@ -138,7 +149,7 @@ int execute(const char * name, DataBlock *config_block, DataBlock *data_block) {
   status = log_info(MODULE_NAME, "long is %ld.", long_scalar);
   if (DataBlock_get_float(data_block, PARAMETERS_SECTION, "float", &float_scalar) < 0) return -1;
   status = log_info(MODULE_NAME, "float is %.3f.", float_scalar);
-  if (DataBlock_get_double(data_block, PARAMETERS_SECTION, "double", &double_scalar) < 0) return -1;
+  if (DataBlock_get_double_k(data_block, double_key, &double_scalar) < 0) return -1;
   status = log_info(MODULE_NAME, "double is %.3f.", double_scalar);
   if (DataBlock_get_string(data_block, PARAMETERS_SECTION, "string", &string_scalar) < 0) return -1;
   status = log_info(MODULE_NAME, "string is %s.", string_scalar);
@@ -148,7 +159,7 @@ int execute(const char * name, DataBlock *config_block, DataBlock *data_block) {
   if ((ndim != NDIM) || (shape[0] != ASIZE) || !alllong(long_array,answer,ASIZE)) return -1;
   if (DataBlock_get_float_array(data_block, PARAMETERS_SECTION, "float_array", &float_array, &ndim, &shape) < 0) return -1;
   if ((ndim != NDIM) || (shape[0] != ASIZE) || !allfloat(float_array,(float) answer,ASIZE)) return -1;
-  if (DataBlock_get_double_array(data_block, PARAMETERS_SECTION, "double_array", &double_array, &ndim, &shape) < 0) return -1;
+  if (DataBlock_get_double_array_k(data_block, double_array_key, &double_array, &ndim, &shape) < 0) return -1;
   if ((ndim != NDIM) || (shape[0] != ASIZE) || !alldouble(double_array,(double) answer,ASIZE)) return -1;
   // In place operations, values in DataBlock updated automatically
   for (size_t i=0;i<shape[0];i++)
@@ -181,6 +192,10 @@ int execute(const char * name, DataBlock *config_block, DataBlock *data_block) {
 int cleanup(const char * name, DataBlock *config_block, DataBlock *data_block) {
   // Clean up, i.e. free variables if needed (called at the end)
   int status = log_info(MODULE_NAME, "Cleaning up module [%s].", name);
+  DataBlock_free_key(double_key);
+  double_key = NULL;
+  DataBlock_free_key(double_array_key);
+  double_array_key = NULL;
   return status;
 }
 
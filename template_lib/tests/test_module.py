@@ -5,6 +5,7 @@ import yaml
 import numpy as np
 
 from pypescript import ConfigBlock, DataBlock, BaseModule, syntax
+from pypescript.block import array_conversions
 from pypescript.utils import setup_logging, MemoryMonitor
 from pypescript.libutils import generate_rst_doc_table
 
@@ -72,6 +73,30 @@ def test_extensions(name='test'):
                 basic_run(module)
 
 
+def test_array_conversions(name='test'):
+
+    for lang in ['c','f90']:
+        options = {}
+        options[syntax.module_name] = 'template_lib.module_{}.module'.format(lang)
+        module = BaseModule.from_filename(name=name,options=options)
+        module.setup()
+        module.data_block['external','int_array'] = np.ones(36,dtype='i4')
+        module.data_block['external','float_array'] = np.ones(36,dtype='f4')
+        # external.declared_array is declared as a double array of size 100: no copy if it already is one
+        module.data_block['external','declared_array'] = np.ones(100,dtype='f8')
+        array_conversions(reset=True)
+        module.execute()
+        nconversions = array_conversions(reset=True)
+        assert np.all(module.data_block['external','declared_array'] == 2)
+        # one more copy otherwise
+        module.data_block['external','declared_array'] = np.ones(100,dtype='f4')
+        module.execute()
+        assert array_conversions(reset=True) == nconversions + 1
+        declared = module.data_block['external','declared_array']
+        assert declared.dtype == np.float64 and np.all(declared == 2)
+        module.cleanup()
+
+
 def test_doc():
     with open(os.path.join(module_dir,'template_lib','module_f90','module.yaml'),'r') as file:
         description = yaml.load(file,Loader=yaml.SafeLoader)
@@ -84,4 +109,5 @@ if __name__ == '__main__':
     setup_logging()
     test_py()
     test_extensions()
+    test_array_conversions()
     test_doc()
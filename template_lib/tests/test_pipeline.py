@@ -1,8 +1,10 @@
 import os
+import time
 import yaml
 import pytest
+import numpy as np
 
-from pypescript import BaseModule, BasePipeline, ConfigBlock, SectionBlock
+from pypescript import BaseModule, BasePipeline, StreamPipeline, DAGPipeline, MPIPipeline, ConfigBlock, DataBlock, SectionBlock
 from pypescript.utils import setup_logging, MemoryMonitor
 from template_lib.model import FlatModel
 from template_lib.likelihood import BaseLikelihood, JointGaussianLikelihood
@@ -122,6 +124,14 @@ def test_demo5():
     pipeline = BasePipeline(config_block=config_fn)
     pipeline.setup()
     pipeline.execute()
+    ysave = pipeline.pipe_block[section_names.data,'ysave']
+    pipeline.cleanup()
+    config = ConfigBlock(config_fn).raw
+    config['batch']['$executor'] = 'subprocess'
+    pipeline = BasePipeline(config_block=config)
+    pipeline.setup()
+    pipeline.execute()
+    assert np.all(pipeline.pipe_block[section_names.data,'ysave'] == ysave)
     pipeline.cleanup()
 
 
@@ -133,6 +143,341 @@ def test_demo6():
     pipeline.cleanup()
 
 
+def test_batch_pool():
+    config_fn = os.path.join(demo_dir,'demo5.yaml')
+    results = {}
+    for executor in ['pool','subprocess']:
+        config = ConfigBlock(config_fn).raw
+        config['batch'].update({'$iter':4,'$executor':executor,'$nworkers':2,'$datablock_iter':{'parameters.a':[1.,2.,3.,4.]},
+                                '$datablock_key_iter':{'likelihood.loglkl':['loglkl{:d}'.format(i) for i in range(4)]}})
+        pipeline = BasePipeline(config_block=config)
+        pipeline.setup()
+        batch = pipeline.modules['batch']
+        assert batch.executor == executor
+        for i in range(2):
+            pipeline.execute()
+            results[executor] = [pipeline.pipe_block[section_names.likelihood,'loglkl{:d}'.format(i)] for i in range(4)]
+        pipeline.cleanup()
+        assert batch._pool is None
+    assert results['pool'] == results['subprocess']
+
+
+class SleepModule(BaseModule):
+
+    def setup(self):
+        pass
+
+    def execute(self):
+        start = time.perf_counter()
+        time.sleep(0.2)
+        self.data_block[section_names.model,'y'] = self.data_block[section_names.parameters,'a'] + 1.
+        self.interval = (start,time.perf_counter())
+
+    def cleanup(self):
+        pass
+
+
+class SumModule(BaseModule):
+
+    def setup(self):
+        pass
+
+    def execute(self):
+        self.interval = (time.perf_counter(),None)
+        self.data_block[section_names.likelihood,'loglkl'] = sum(self.data_block[section_names.model,name] for name in ['y1','y2','y3'])
+
+    def cleanup(self):
+        pass
+
+
+def assert_concurrent(models, like, concurrent=True):
+    # models ran concurrently (all intervals overlap) or one after the other, and like after all of them
+    intervals = sorted(model.interval for model in models)
+    if concurrent:
+        assert max(start for start,stop in intervals) < min(stop for start,stop in intervals)
+    else:
+        assert all(stop <= start for (_,stop),(start,_) in zip(intervals[:-1],intervals[1:]))
+    assert like.interval[0] >= max(stop for start,stop in intervals)
+
+
+def test_dag():
+
+    description = {'execute input':{'parameters.a':{}},'execute output':{'model.y':{}}}
+    for nthreads in [1,3]:
+        models = [SleepModule(name='model{:d}'.format(i),description=description,options={'$datablock_mapping':{'model.y':'model.y{:d}'.format(i)}}) for i in range(1,4)]
+        like = SumModule(name='like',description={'inputs':['model'],'outputs':['likelihood.loglkl']})
+        pipeline = DAGPipeline(modules=models + [like],options={'$nthreads':nthreads})
+        assert pipeline.get_graph(pipeline.execute_todos) == ([[3],[3],[3],[]],[0,0,0,3])
+        pipeline.setup()
+        pipeline.data_block[section_names.parameters,'a'] = 1.
+        pipeline.execute()
+        assert_concurrent(models,like,concurrent=nthreads > 1)
+        assert pipeline.pipe_block[section_names.likelihood,'loglkl'] == 6.
+        pipeline.cleanup()
+    # no description: run serially
+    models = [SleepModule(name='model{:d}'.format(i),options={'$datablock_mapping':{'model.y':'model.y{:d}'.format(i)}}) for i in range(1,4)]
+    pipeline = DAGPipeline(modules=models + [like],options={'$nthreads':3})
+    assert pipeline.get_graph(pipeline.execute_todos)[1] == [0,1,2,3]
+
+
+def test_trace():
+
+    description = {'execute input':{'parameters.a':{}},'execute output':{'model.y':{}}}
+    models = [SleepModule(name='model1',description=description,options={'$datablock_mapping':{'model.y':'model.y1'}}),
+              SleepModule(name='model2',description={'execute input':{'parameters.a':{}}}),
+              SleepModule(name='model3',options={'$datablock_mapping':{'model.y':'model.y3'}})]
+    like = SumModule(name='like',options={'$datablock_mapping':{'model.y2':'model.y'}})
+    pipeline = DAGPipeline(modules=models + [like],options={'$nthreads':3})
+    pipeline.setup()
+    pipeline.data_block[section_names.parameters,'a'] = 1.
+    pipeline.set_trace()
+    pipeline.execute()
+    trace = [row for row in pipeline.get_trace() if row[1] == 'execute']
+    assert ('model1','execute','model','y1','set',True) in trace
+    assert ('model2','execute','model','y','set',False) in trace
+    assert ('model3','execute','parameters','a','get',None) in trace
+    assert ('like','execute','model','y','get',None) in trace
+    pipeline.log_trace()
+    pipeline.set_trace(False)
+    # without description, recorded accesses are not used to run modules concurrently
+    models = [SleepModule(name='model{:d}'.format(i),options={'$datablock_mapping':{'model.y':'model.y{:d}'.format(i)}}) for i in range(1,4)]
+    like = SumModule(name='like')
+    pipeline = DAGPipeline(modules=models + [like],options={'$nthreads':3})
+    pipeline.setup()
+    pipeline.data_block[section_names.parameters,'a'] = 1.
+    pipeline.set_trace()
+    pipeline.execute()
+    assert pipeline.execute_todos[0].io() == ({(section_names.parameters,'a')},{(section_names.model,'y1')})
+    assert pipeline.get_graph(pipeline.execute_todos)[1] == [0,1,2,3]
+    pipeline.execute()
+    assert_concurrent(models,like,concurrent=False)
+    assert pipeline.pipe_block[section_names.likelihood,'loglkl'] == 6.
+
+
+class CountModule(BaseModule):
+
+    def setup(self):
+        self.count = 0
+
+    def execute(self):
+        self.count += 1
+        self.data_block[section_names.model,'y'] = self.data_block[section_names.parameters,'a'] * self.data_block[section_names.parameters,'b']
+
+    def cleanup(self):
+        pass
+
+
+def test_cache():
+
+    description = {'execute input':{'parameters.a':{},'parameters.b':{}},'execute output':{'model.y':{}}}
+    model1 = CountModule(name='model1',description=description,options={'$cache':2,'$datablock_mapping':{'model.y':'model.y1'}})
+    model2 = CountModule(name='model2',options={'$cache':True,'$datablock_mapping':{'model.y':'model.y2'}})
+    pipeline = BasePipeline(modules=[model1,model2],options={'$datablock_duplicate':['model.y1','model.y2']})
+    pipeline.setup()
+    pipeline.data_block[section_names.parameters,'b'] = np.arange(3.)
+    for a,count1,count2 in zip([1.,1.,2.,1.,3.,2.,2.],[1,1,2,2,3,4,4],[1,1,2,3,4,5,5]):
+        pipeline.data_block[section_names.parameters,'a'] = a
+        pipeline.execute()
+        assert (model1.count,model2.count) == (count1,count2)
+        for name in ['y1','y2']:
+            assert np.all(pipeline.data_block[section_names.model,name] == a*np.arange(3.))
+    pipeline.data_block[section_names.parameters,'b'] = np.ones(3)
+    pipeline.execute()
+    assert (model1.count,model2.count) == (5,6)
+    # setup clears cache
+    pipeline.setup()
+    pipeline.execute()
+    assert (model1.count,model2.count) == (1,1)
+
+
+def test_checkpoint(tmp_path):
+
+    model = CountModule(name='model')
+    pipeline = BasePipeline(modules=[model])
+    pipeline.setup()
+    pipeline.data_block[section_names.parameters,'b'] = np.ones(100000)
+    fn = str(tmp_path / 'checkpoint.block')
+    sizes = []
+    for a in [1.,2.]:
+        pipeline.data_block[section_names.parameters,'a'] = a
+        pipeline.execute()
+        pipeline.checkpoint(fn)
+        sizes.append(os.path.getsize(fn))
+    # only parameters.a and model.y are written again, not parameters.b
+    assert sizes[1] - sizes[0] < 1.5*pipeline.data_block[section_names.parameters,'b'].nbytes
+    del pipeline.data_block[section_names.parameters,'b']
+    pipeline.data_block[section_names.parameters,'b'] = 2.
+    pipeline.execute()
+    pipeline.checkpoint(fn)
+    block = DataBlock.restore(fn)
+    keys = set(pipeline.pipe_block.keys()) - {(section_names.mpi,'comm')}
+    assert set(block.keys()) - {(section_names.mpi,'comm')} == keys
+    for key in keys:
+        assert np.all(block[key] == pipeline.pipe_block[key])
+
+
+class SectionModule(CountModule):
+
+    def execute(self):
+        self.count += 1
+        self.data_block[section_names.model]['z'] = self.data_block[section_names.parameters,'a'] * np.ones(3)
+
+
+class InPlaceModule(CountModule):
+
+    def execute(self):
+        self.data_block[section_names.model,'y'] *= 10.
+        self.data_block[section_names.model,'z'] += 1.
+
+
+def test_cache_in_place():
+
+    model = CountModule(name='model',options={'$cache':True})
+    section = SectionModule(name='section',options={'$cache':True})
+    inplace = InPlaceModule(name='inplace')
+    pipeline = BasePipeline(modules=[model,section,inplace],options={'$datablock_duplicate':['model.y','model.z']})
+    pipeline.setup()
+    pipeline.data_block[section_names.parameters,'b'] = np.arange(3.)
+    for a,count in zip([1.,1.,2.,2.,1.],[1,1,2,2,3]):
+        pipeline.data_block[section_names.parameters,'a'] = a
+        pipeline.execute()
+        assert model.count == section.count == count
+        assert np.all(pipeline.data_block[section_names.model,'y'] == 10.*a*np.arange(3.))
+        assert np.all(pipeline.data_block[section_names.model,'z'] == a + 1.)
+
+
+class Parameters(object):
+
+    def __init__(self, a):
+        self.a = a
+
+
+class ObjectModule(CountModule):
+
+    def execute(self):
+        self.count += 1
+        self.data_block[section_names.model,'y'] = self.data_block[section_names.parameters,'a'].a * 2
+
+
+def test_cache_hash():
+
+    model = ObjectModule(name='model',options={'$cache':4})
+    pipeline = BasePipeline(modules=[model])
+    pipeline.setup()
+    parameters = Parameters(1.)
+    pipeline.data_block[section_names.parameters,'a'] = parameters
+    pipeline.execute()
+    # objects modified in place are hashed by value, not identity
+    parameters.a = 2.
+    pipeline.execute()
+    assert model.count == 2 and pipeline.pipe_block[section_names.model,'y'] == 4.
+    model = CountModule(name='model',options={'$cache':4})
+    pipeline = BasePipeline(modules=[model])
+    pipeline.setup()
+    pipeline.data_block[section_names.parameters,'b'] = 1
+    # equal scalars of different types are different inputs
+    for a,count in zip([1,1.,True,1,np.float64(1.)],[1,2,3,3,4]):
+        pipeline.data_block[section_names.parameters,'a'] = a
+        pipeline.execute()
+        assert model.count == count and type(pipeline.pipe_block[section_names.model,'y']) is type(a*1)
+
+
+class FastModule(CountModule):
+
+    def execute(self):
+        self.count += 1
+        self.data_block[section_names.likelihood,'loglkl'] = self.data_block[section_names.model,'y'] + self.data_block[section_names.parameters,'c']
+
+
+def test_speed():
+
+    for Pipeline in [BasePipeline,StreamPipeline,DAGPipeline]:
+        model = CountModule(name='model',description={'speed':'slow','execute input':{'parameters.a':{},'parameters.b':{}},'execute output':{'model.y':{}}})
+        like = FastModule(name='like',description={'execute input':{'parameters.c':{},'model.y':{}},'execute output':{'likelihood.loglkl':{}}},options={'$speed':'fast'})
+        pipeline = Pipeline(modules=[model,like],options={'$nthreads':2,'$datablock_duplicate':['likelihood.loglkl']})
+        assert list(pipeline.get_tiers().keys()) == ['slow','fast']
+        assert pipeline.get_speed_blocks(['parameters.a',('parameters','b'),'parameters.c']) == [(('slow','fast'),['parameters.a',('parameters','b')]),(('fast',),['parameters.c'])]
+        pipeline.setup()
+        for name,value in zip(['a','b','c'],[1.,2.,3.]):
+            pipeline.data_block[section_names.parameters,name] = value
+        pipeline.execute(changed_keys=['parameters.c']) # first execution: all modules are run
+        assert (model.count,like.count) == (1,1)
+        assert pipeline.data_block[section_names.likelihood,'loglkl'] == 5.
+        pipeline.data_block[section_names.parameters,'c'] = 4.
+        pipeline.execute(changed_keys=['parameters.c'])
+        assert (model.count,like.count) == (1,2)
+        assert pipeline.data_block[section_names.likelihood,'loglkl'] == 6.
+        pipeline.data_block[section_names.parameters,'a'] = 2.
+        pipeline.execute(changed_keys=['parameters'])
+        assert (model.count,like.count) == (2,3)
+        assert pipeline.data_block[section_names.likelihood,'loglkl'] == 8.
+        pipeline.execute()
+        assert (model.count,like.count) == (3,4)
+        timings = pipeline.get_tier_timings()
+        assert list(timings.keys()) == ['slow','fast'] and all(timing > 0. for timing in timings.values())
+        pipeline.cleanup()
+
+
+def test_profiler():
+
+    description = {'execute input':{'parameters.a':{},'parameters.b':{}},'execute output':{'model.y':{}}}
+    model = CountModule(name='model',description=description,options={'$cache':True,'$datablock_set':{'parameters.b':2.}})
+    like = FastModule(name='like',options={'$datablock_duplicate':{'likelihood.loglkl2':'likelihood.loglkl'}})
+    pipeline = BasePipeline(modules=[BasePipeline(name='sub',modules=[model],options={'$datablock_duplicate':['model.y']}),like])
+    profiler = pipeline.set_profiler()
+    assert profiler.events is None
+    pipeline.data_block[section_names.parameters,'a'] = 1.
+    pipeline.data_block[section_names.parameters,'c'] = 1.
+    pipeline.setup()
+    for i in range(3):
+        pipeline.execute()
+    stats = profiler.mpi_gather().stats
+    assert stats['model','execute','step'][0] == 1 and stats['model','execute','cache'][0] == 3
+    assert stats['like','execute','step'][0] == 3 and stats['like','execute','datablock_duplicate'][0] == 3
+    assert stats['sub','execute','step'][0] == 3
+    profiler.log_table()
+    pipeline.set_profiler(False)
+    pipeline.execute()
+    assert profiler.stats['like','execute','step'][0] == 3
+
+
+class Distributed(object):
+
+    ndistribute = 0
+
+    def mpi_distribute(self, dests, mpicomm=None):
+        Distributed.ndistribute += 1
+        return self
+
+
+def test_mpi_persistent():
+
+    for persistent in [False,True]:
+        model = CountModule(name='model')
+        options = {'$iter':3,'$persistent_workers':persistent,'$datablock_iter':{'parameters':{'a':[1.,2.,3.]}},
+                   '$datablock_key_iter':{'model':{'y':['y0','y1','y2']}}}
+        pipeline = MPIPipeline(name='mpi',modules=[model],options=options)
+        pipeline.setup()
+        Distributed.ndistribute = 0
+        pipeline.data_block[section_names.parameters,'b'] = 2.
+        pipeline.data_block[section_names.data,'obj'] = Distributed()
+        tms = []
+        for i in range(3):
+            pipeline.execute()
+            tms.append(pipeline._task_manager)
+            assert [pipeline.data_block[section_names.model,'y{:d}'.format(i)] for i in range(3)] == [2.,4.,6.]
+        assert Distributed.ndistribute == (1 if persistent else 3)
+        if persistent:
+            assert tms[0] is not None and all(tm is tms[0] for tm in tms)
+            pipeline.data_block[section_names.data,'obj'] = Distributed()
+            pipeline.execute()
+            assert Distributed.ndistribute == 2
+        else:
+            assert all(tm is None for tm in tms)
+        pipeline.cleanup()
+        assert pipeline._task_manager is None
+
+
 if __name__ == '__main__':
 
     setup_logging()
@@ -146,3 +491,4 @@ if __name__ == '__main__':
             test_demo4()
             test_demo5()
             test_demo6()
+            test_batch_pool()